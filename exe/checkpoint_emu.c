@@ -0,0 +1,325 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/buffer_pool.h"
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/log.h"
+#include "mpi_test_utils/straggler.h"
+
+#include <mpi.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHUNK_SIZE M_SIZE
+
+typedef struct {
+    char file_name[4096];
+    off_t offset;
+    size_t bytes;
+    bool sync;
+} ckpt_target_t;
+
+typedef struct {
+    const ckpt_target_t* target;
+    const char* buffer;
+    int status;
+    int64_t elapsed_ns;
+    pthread_t tid;
+} ckpt_writer_t;
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void compute_phase(double seconds, bool busy_wait)
+{
+    int64_t duration_ns = (int64_t)(seconds * 1e9);
+    if (busy_wait) {
+        int64_t end = now_ns() + duration_ns;
+        volatile uint64_t sink = 0;
+        while (now_ns() < end) {
+            for (int i = 0; i < 1000; i++) {
+                sink = sink * 6364136223846793005ULL + 1;
+            }
+        }
+        return;
+    }
+    struct timespec ts = { (time_t)(duration_ns / 1000000000), (long)(duration_ns % 1000000000) };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) { }
+}
+
+// Write or read back one rank's checkpoint. A written checkpoint is made durable and then evicted from the
+// page cache, so that the restart read has to hit storage.
+static int transfer_checkpoint(const ckpt_target_t* target, char* buffer, bool write)
+{
+    int fd = write ? open(target->file_name, O_WRONLY | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR)
+                   : open(target->file_name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        perror(write ? "Failed to open checkpoint for writing" : "Failed to open checkpoint for reading");
+        return -1;
+    }
+    for (size_t done = 0; done < target->bytes; done += CHUNK_SIZE) {
+        size_t len = target->bytes - done < CHUNK_SIZE ? target->bytes - done : CHUNK_SIZE;
+        off_t offset = target->offset + (off_t)done;
+        ssize_t ret = write ? pwrite(fd, buffer + done, len, offset) : pread(fd, buffer + done, len, offset);
+        if (ret != (ssize_t)len) {
+            perror(write ? "Failed to write checkpoint" : "Failed to read checkpoint");
+            close(fd);
+            return -1;
+        }
+    }
+    if (write && target->sync) {
+        if (fdatasync(fd) != 0) {
+            perror("Failed to sync checkpoint");
+            close(fd);
+            return -1;
+        }
+        posix_fadvise(fd, target->offset, (off_t)target->bytes, POSIX_FADV_DONTNEED);
+    }
+    close(fd);
+    return 0;
+}
+
+static void* writer_main(void* arg)
+{
+    ckpt_writer_t* writer = arg;
+    int64_t start = now_ns();
+    writer->status = transfer_checkpoint(writer->target, (char*)writer->buffer, true);
+    writer->elapsed_ns = now_ns() - start;
+    return NULL;
+}
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+        "Usage: %s [-n checkpoints] [-c compute seconds] [-B] [-s MiB per rank] [-d directory] [-S] [-a] [-N]\n"
+        "          [-H] [-L]\n"
+        "  -n  Number of compute/checkpoint cycles (default 5)\n"
+        "  -c  Length of each compute phase in seconds (default 1.0)\n"
+        "  -B  Busy-wait during compute phases instead of sleeping\n"
+        "  -s  Checkpoint size per rank in MiB (default 256)\n"
+        "  -d  Directory of checkpoint files (default .)\n"
+        "  -S  All ranks write one shared file instead of one file per rank\n"
+        "  -a  Write checkpoints asynchronously, overlapped with the next compute phase\n"
+        "  -N  Do not fdatasync checkpoints\n"
+        "  -H  Back checkpoint buffers with huge pages\n"
+        "  -L  mlock checkpoint buffers\n",
+        prog);
+}
+
+int main(int argc, char** argv)
+{
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    size_t n_checkpoints = 5;
+    double compute_s = 1.0;
+    bool busy_wait = false;
+    size_t size_mib = 256;
+    const char* directory = ".";
+    bool shared_file = false;
+    bool async_write = false;
+    bool sync = true;
+    int buffer_flags = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:c:Bs:d:SaNHLh")) != -1) {
+        switch (opt) {
+        case 'n':
+            n_checkpoints = strtoull(optarg, NULL, 10);
+            break;
+        case 'c':
+            compute_s = strtod(optarg, NULL);
+            break;
+        case 'B':
+            busy_wait = true;
+            break;
+        case 's':
+            size_mib = strtoull(optarg, NULL, 10);
+            break;
+        case 'd':
+            directory = optarg;
+            break;
+        case 'S':
+            shared_file = true;
+            break;
+        case 'a':
+            async_write = true;
+            break;
+        case 'N':
+            sync = false;
+            break;
+        case 'H':
+            buffer_flags |= BUFFER_HUGE_PAGES;
+            break;
+        case 'L':
+            buffer_flags |= BUFFER_LOCKED;
+            break;
+        default:
+            if (rank == 0) {
+                usage(argv[0]);
+            }
+            MPI_Finalize();
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (provided < MPI_THREAD_FUNNELED || !(compute_s >= 0)) {
+        if (rank == 0) {
+            fprintf(stderr, "Compute time must not be negative, or MPI lacks MPI_THREAD_FUNNELED\n");
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    env_report(directory, MPI_COMM_WORLD, NULL, stdout);
+
+    ckpt_target_t target = { .bytes = size_mib * M_SIZE, .sync = sync };
+    if (shared_file) {
+        snprintf(target.file_name, sizeof(target.file_name), "%s/ckpt.shared", directory);
+        target.offset = (off_t)((size_t)rank * target.bytes);
+    } else {
+        snprintf(target.file_name, sizeof(target.file_name), "%s/ckpt.%d", directory, rank);
+    }
+    // Application state, and a staging copy that the asynchronous writer drains.
+    buffer_t state_buffer = { 0 };
+    buffer_t staging_buffer = { 0 };
+    if (buffer_alloc(&state_buffer, target.bytes, buffer_flags) != 0
+        || (async_write && buffer_alloc(&staging_buffer, target.bytes, buffer_flags) != 0)) {
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    char* state = state_buffer.data;
+    char* staging = staging_buffer.data;
+    if (rank == 0) {
+        log_info("Checkpoint emulation: %d ranks x %zu MiB, %s, %s writes, %zu cycles of %.3f s compute", size,
+            size_mib, shared_file ? "shared file" : "file per process", async_write ? "asynchronous" : "blocking",
+            n_checkpoints, compute_s);
+    }
+
+    int status = 0;
+    ckpt_writer_t writer = { .target = &target, .buffer = staging };
+    bool writer_running = false;
+    int64_t total_blocking_ns = 0;
+    int64_t total_write_ns = 0;
+    int64_t total_exposed_ns = 0;
+    for (size_t c = 0; c < n_checkpoints && status == 0; c++) {
+        compute_phase(compute_s, busy_wait);
+        // Fill the state so every checkpoint carries different data.
+        memset(state, (int)(c + 1), target.bytes);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        int64_t start = now_ns();
+        if (async_write) {
+            // The previous checkpoint must be durable before its staging buffer can be reused.
+            if (writer_running) {
+                pthread_join(writer.tid, NULL);
+                writer_running = false;
+                status = writer.status;
+                total_write_ns += writer.elapsed_ns;
+            }
+            int64_t exposed_wait_ns = now_ns() - start;
+            total_exposed_ns += exposed_wait_ns;
+            memcpy(staging, state, target.bytes);
+            if (status == 0 && pthread_create(&writer.tid, NULL, writer_main, &writer) != 0) {
+                perror("Failed to start checkpoint writer");
+                status = -1;
+            }
+            writer_running = status == 0;
+        } else {
+            status = transfer_checkpoint(&target, state, true);
+        }
+        int64_t blocking_ns = now_ns() - start;
+        int64_t max_blocking_ns = 0;
+        int any_failed = 0;
+        MPI_Allreduce(&status, &any_failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+        MPI_Reduce(&blocking_ns, &max_blocking_ns, 1, MPI_INT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+        if (any_failed) {
+            status = -1;
+            break;
+        }
+        total_blocking_ns += max_blocking_ns;
+        if (!async_write) {
+            total_write_ns += blocking_ns;
+        }
+        if (rank == 0) {
+            printf("Checkpoint %zu: time-to-checkpoint %.3f s (%.3f MB/s aggregate)\n", c, max_blocking_ns / 1e9,
+                (double)target.bytes * size / (double)max_blocking_ns * 1e3);
+        }
+    }
+    if (writer_running) {
+        int64_t start = now_ns();
+        pthread_join(writer.tid, NULL);
+        total_exposed_ns += now_ns() - start;
+        total_write_ns += writer.elapsed_ns;
+        if (writer.status != 0) {
+            status = -1;
+        }
+    }
+    int any_failed = 0;
+    MPI_Allreduce(&status, &any_failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+
+    if (!any_failed && n_checkpoints > 0) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        int64_t start = now_ns();
+        status = transfer_checkpoint(&target, state, false);
+        int64_t restart_ns = now_ns() - start;
+        int64_t max_restart_ns = 0;
+        MPI_Allreduce(&status, &any_failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+        MPI_Reduce(&restart_ns, &max_restart_ns, 1, MPI_INT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+
+        // Overlap is the share of write time hidden behind compute phases, averaged over ranks.
+        double overlap = 0.0;
+        if (async_write && total_write_ns > 0) {
+            overlap = 1.0 - (double)total_exposed_ns / (double)total_write_ns;
+            overlap = overlap < 0.0 ? 0.0 : overlap;
+        }
+        double mean_overlap = 0.0;
+        MPI_Reduce(&overlap, &mean_overlap, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        if (rank == 0 && !any_failed) {
+            printf("Mean time-to-checkpoint: %.3f s\n", (double)total_blocking_ns / (double)n_checkpoints / 1e9);
+            printf("Restart read: %.3f s (%.3f MB/s aggregate)\n", max_restart_ns / 1e9,
+                (double)target.bytes * size / (double)max_restart_ns * 1e3);
+            if (async_write) {
+                printf("Achieved overlap: %.1f%%\n", mean_overlap / size * 100.0);
+            }
+        }
+
+        // Seconds spent writing and reading back, per rank.
+        straggler_report_t report;
+        if (straggler_detect((double)total_write_ns / 1e9, false, STRAGGLER_DEFAULT_Z, MPI_COMM_WORLD, &report) == 0
+            && rank == 0) {
+            straggler_report_print(&report, "checkpoint write seconds", stdout);
+        }
+        straggler_report_free(&report);
+        if (straggler_detect((double)restart_ns / 1e9, false, STRAGGLER_DEFAULT_Z, MPI_COMM_WORLD, &report) == 0
+            && rank == 0) {
+            straggler_report_print(&report, "restart read seconds", stdout);
+        }
+        straggler_report_free(&report);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (!shared_file || rank == 0) {
+        unlink(target.file_name);
+    }
+    buffer_release(&staging_buffer);
+    buffer_release(&state_buffer);
+    MPI_Finalize();
+    return any_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
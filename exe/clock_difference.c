@@ -3,11 +3,15 @@
 // POSIX source
 #define _POSIX_C_SOURCE 200809L // NOLINT
 
+#include "mpi_test_utils/environment.h"
 #include "mpi_test_utils/fmt.h"
 #include "mpi_test_utils/log.h"
+#include "mpi_test_utils/stats.h"
+#include "mpi_test_utils/straggler.h"
 
 #include <mpi.h>
 
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -26,6 +30,7 @@ int main()
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         return EXIT_FAILURE;
     }
+    env_report(".", MPI_COMM_WORLD, NULL, stdout);
 
     if (rank == 0) {
         log_info("%s", "Starting clock difference measurement across MPI processes...");
@@ -44,17 +49,37 @@ int main()
 
     // Collect all timestamps
     int64_t* all_times_ns = calloc(size, sizeof(int64_t));
+    double* offsets_ns = calloc(size, sizeof(double));
+    if (all_times_ns == NULL || offsets_ns == NULL) {
+        perror("Failed to allocate timestamps");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
     MPI_Allgather(&clock_ns, 1, MPI_INT64_T, all_times_ns, 1, MPI_INT64_T, MPI_COMM_WORLD);
+
+    // A rank whose clock is far from the median of all clocks is out of sync with the rest.
+    for (int i = 0; i < size; i++) {
+        offsets_ns[i] = (double)(all_times_ns[i] - all_times_ns[0]);
+    }
+    double median_offset_ns = stats_median(offsets_ns, size);
+    straggler_report_t report;
+    int straggler_status = straggler_detect(
+        fabs(offsets_ns[rank] - median_offset_ns), false, STRAGGLER_DEFAULT_Z, MPI_COMM_WORLD, &report);
+    free(offsets_ns);
     if (rank != 0) {
+        straggler_report_free(&report);
         free(all_times_ns);
         MPI_Finalize();
-        return EXIT_SUCCESS;
+        return straggler_status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
     }
     if (rank == 0) {
         log_info("%s", "Analyzing clock difference measurement across MPI processes...");
     }
     // Calculate all pair-wise differences
     int64_t* all_time_diff = calloc(size * size, sizeof(int64_t));
+    if (all_time_diff == NULL) {
+        perror("Failed to allocate clock differences");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
     int64_t maxdiff = INT64_MIN;
     for (int i = 0; i < size; i++) {
         for (int j = 0; j < size; j++) {
@@ -69,6 +94,7 @@ int main()
     FILE* csv_file = fopen("clock_differences.csv", "w");
     if (csv_file == NULL) {
         perror("Failed to open CSV file for writing");
+        straggler_report_free(&report);
         free(all_time_diff);
         free(all_times_ns);
         MPI_Finalize();
@@ -94,9 +120,17 @@ int main()
     char* maxdiff_str = format_with_comma_u64(maxdiff);
     printf("Maximum clock difference observed: %s ns\n", maxdiff_str);
     free(maxdiff_str);
+    int status = EXIT_SUCCESS;
+    if (straggler_status == 0) {
+        straggler_report_print(&report, "clock offset from median ns", stdout);
+    } else {
+        log_error("%s", "Straggler detection of clock offsets failed");
+        status = EXIT_FAILURE;
+    }
+    straggler_report_free(&report);
     free(all_time_diff);
     free(all_times_ns);
     log_info("%s", "Done!");
     MPI_Finalize();
-    return EXIT_SUCCESS;
+    return status;
 }
@@ -0,0 +1,128 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/autotune.h"
+#include "mpi_test_utils/buffer_pool.h"
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/io_engines.h"
+#include "mpi_test_utils/log.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Shell-sourceable configuration for job launchers.
+static int write_recommendation(const char* path, const autotune_config_t* config, const autotune_result_t* result)
+{
+    FILE* out = fopen(path, "we");
+    if (out == NULL) {
+        perror("Failed to open output file");
+        return -1;
+    }
+    fprintf(out, "IO_DIRECTION=%s\n", config->read ? "read" : "write");
+    fprintf(out, "IO_ENGINE=%s\n", io_engine_name(result->best.engine));
+    fprintf(out, "IO_BLOCK_SIZE=%zu\n", result->best.block_size);
+    fprintf(out, "IO_THREADS=%zu\n", result->best.n_threads);
+    fprintf(out, "IO_QUEUE_DEPTH=%zu\n", result->best.engine == IO_ENGINE_AIO ? result->best.queue_depth : 1);
+    fprintf(out, "IO_EXPECTED_MBPS=%.1f\n", result->best_mbps);
+    if (fclose(out) != 0) {
+        perror("Failed to write output file");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    autotune_config_t config = {
+        .dir = ".",
+        .budget_ns = 60000000000ULL,
+        .read = false,
+        .sync = true,
+        .file_size = G_SIZE,
+        .max_threads = n_cpus > 0 ? (size_t)n_cpus : 1,
+        .min_gain = 0.05,
+    };
+    const char* output = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:T:rSs:t:g:o:h")) != -1) {
+        switch (opt) {
+        case 'd':
+            config.dir = optarg;
+            break;
+        case 'T':
+            config.budget_ns = (uint64_t)(strtod(optarg, NULL) * 1e9);
+            break;
+        case 'r':
+            config.read = true;
+            break;
+        case 'S':
+            config.sync = false;
+            break;
+        case 's':
+            config.file_size = strtoull(optarg, NULL, 10) * M_SIZE;
+            break;
+        case 't':
+            config.max_threads = strtoull(optarg, NULL, 10);
+            break;
+        case 'g':
+            config.min_gain = strtod(optarg, NULL);
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        default:
+            fprintf(stderr,
+                "Usage: %s [-d dir] [-T seconds] [-r] [-S] [-s MiB] [-t threads] [-g gain] [-o file]\n"
+                "  -d  Directory of the test file (default .)\n"
+                "  -T  Time budget in seconds (default 60)\n"
+                "  -r  Tune reads instead of writes\n"
+                "  -S  Do not flush writes to storage, i.e. measure the page cache\n"
+                "  -s  Data per trial in MiB (default 1024)\n"
+                "  -t  Maximum threads (default: online CPUs)\n"
+                "  -g  Relative gain below which a search direction is abandoned (default 0.05)\n"
+                "  -o  Write the recommendation as shell variables to this file\n",
+                argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (config.file_size == 0 || config.max_threads == 0 || config.budget_ns == 0) {
+        fprintf(stderr, "Invalid trial size, thread count or budget\n");
+        return EXIT_FAILURE;
+    }
+    env_fingerprint_t env;
+    env_collect(&env, config.dir);
+    env_write(&env, "# ", stdout);
+
+    autotune_result_t result;
+    int status = autotune_nompi(&config, &result);
+    buffer_pool_clear(buffer_pool_shared());
+    if (status != 0) {
+        log_error("No configuration could be measured");
+        return EXIT_FAILURE;
+    }
+    printf("Trials: %zu in %.1f s%s\n", result.n_trials, (double)result.elapsed_ns / 1e9,
+        result.budget_exhausted ? " (budget exhausted)" : "");
+    for (io_engine_t engine = IO_ENGINE_STDIO; engine < IO_ENGINE_N; engine++) {
+        if (result.engine_mbps[engine] > 0.0) {
+            printf("Best %s: %.1f MB/s\n", io_engine_name(engine), result.engine_mbps[engine]);
+        } else {
+            printf("Best %s: not measured\n", io_engine_name(engine));
+        }
+    }
+    printf("Recommended %s configuration: engine %s, block size %zu, threads %zu", config.read ? "read" : "write",
+        io_engine_name(result.best.engine), result.best.block_size, result.best.n_threads);
+    if (result.best.engine == IO_ENGINE_AIO) {
+        printf(", queue depth %zu", result.best.queue_depth);
+    }
+    printf("\nExpected bandwidth: %.1f MB/s\n", result.best_mbps);
+    if (output != NULL && write_recommendation(output, &config, &result) != 0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
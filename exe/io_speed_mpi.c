@@ -0,0 +1,278 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/buffer_pool.h"
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/io_tester.h"
+#include "mpi_test_utils/log.h"
+#include "mpi_test_utils/straggler.h"
+#include "mpi_test_utils/timeline.h"
+
+#include <mpi.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef enum { SEQ_WRITE, SEQ_READ, RAND_READ } io_test_t;
+
+static const char* io_test_names[] = { "seq_write", "seq_read", "rand_read" };
+
+static ssize_t run_test(io_test_t test, const char* file_name, size_t n_blocks)
+{
+    switch (test) {
+    case SEQ_WRITE:
+        return test_sequential_write_nompi(file_name, BLOCK_SIZE, n_blocks);
+    case SEQ_READ:
+        return test_sequential_read_nompi(file_name, BLOCK_SIZE, n_blocks);
+    case RAND_READ:
+        return test_random_read_nompi(file_name, BLOCK_SIZE, n_blocks, n_blocks);
+    }
+    return -1;
+}
+
+// Run a test on every rank of `comm`. On success, `bandwidth` is the bandwidth of this rank and `aggregate`,
+// valid on rank 0 of `comm`, the bandwidth of all ranks together, both in MB/s.
+static int run_on(io_test_t test, const char* file_name, size_t n_blocks, MPI_Comm comm, double* bandwidth,
+    double* aggregate)
+{
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    MPI_Barrier(comm);
+    ssize_t elapsed_ns = run_test(test, file_name, n_blocks);
+    int failed = elapsed_ns < 0;
+    int any_failed = 0;
+    MPI_Allreduce(&failed, &any_failed, 1, MPI_INT, MPI_LOR, comm);
+    if (any_failed) {
+        if (failed) {
+            log_error("Rank %d %s failed", rank, io_test_names[test]);
+        }
+        return -1;
+    }
+    double total_bytes = (double)(n_blocks * BLOCK_SIZE);
+    *bandwidth = total_bytes / (double)elapsed_ns * 1e3; // bytes per ns convert to MB/s
+    int64_t max_elapsed_ns = 0;
+    int64_t local_elapsed_ns = elapsed_ns;
+    MPI_Reduce(&local_elapsed_ns, &max_elapsed_ns, 1, MPI_INT64_T, MPI_MAX, 0, comm);
+    *aggregate = rank == 0 ? total_bytes * size / (double)max_elapsed_ns * 1e3 : 0.0;
+    return 0;
+}
+
+// Remember hosts of stragglers so that they can be listed for draining at the end.
+static void add_drain_hosts(const straggler_report_t* report, char (*hosts)[MPI_MAX_PROCESSOR_NAME], int* n_hosts)
+{
+    for (size_t i = 0; i < report->n_stragglers; i++) {
+        const char* host = report->stragglers[i].hostname;
+        int j = 0;
+        while (j < *n_hosts && strcmp(hosts[j], host) != 0) {
+            j++;
+        }
+        if (j == *n_hosts) {
+            memcpy(hosts[(*n_hosts)++], host, MPI_MAX_PROCESSOR_NAME);
+        }
+    }
+}
+
+static void report_timeline(timeline_t* tl, const char* prefix, const char* test_name, int rank)
+{
+    uint64_t* merged = NULL;
+    bool overflow = false;
+    size_t n_merged = timeline_reduce(tl, MPI_COMM_WORLD, 0, &merged, &overflow);
+    if (rank != 0 || n_merged == 0) {
+        return;
+    }
+    if (overflow) {
+        log_warn("Timeline of %s ran out of its %zu intervals; samples end at %.3f s, before the test did. "
+                 "Raise -n or -t",
+            test_name, tl->capacity, (double)(n_merged * tl->interval_ns) / 1e9);
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s_%s.csv", prefix, test_name);
+    if (timeline_write_csv(path, tl->interval_ns, merged, n_merged, 0) == 0) {
+        log_info("Timeline of %s written to %s", test_name, path);
+    }
+    timeline_summarize(tl->interval_ns, merged, n_merged, 0, stdout);
+    free(merged);
+}
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+        "Usage: %s [-s MiB per rank] [-d directory] [-t interval ms] [-n max intervals] [-o prefix] [-H] [-L]\n"
+        "          [-z threshold] [-x]\n"
+        "  -s  I/O size per rank in MiB (default 4096)\n"
+        "  -d  Directory for test files (default .)\n"
+        "  -t  Record aggregate bandwidth over time every given milliseconds (default off)\n"
+        "  -n  Capacity of the timeline in intervals (default 36000)\n"
+        "  -o  Prefix of timeline CSV files (default timeline)\n"
+        "  -H  Back I/O buffers with huge pages\n"
+        "  -L  mlock I/O buffers\n"
+        "  -z  Modified z-score above which a rank is reported as a straggler (default 3.5)\n"
+        "  -x  Rerun each test without its stragglers\n",
+        prog);
+}
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    size_t size_mib = 4 * K_SIZE;
+    const char* directory = ".";
+    uint64_t interval_ms = 0;
+    size_t capacity = 36000;
+    const char* prefix = "timeline";
+    int buffer_flags = 0;
+    double z_threshold = STRAGGLER_DEFAULT_Z;
+    bool rerun_without_stragglers = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:d:t:n:o:HLz:xh")) != -1) {
+        switch (opt) {
+        case 's':
+            size_mib = strtoull(optarg, NULL, 10);
+            break;
+        case 'd':
+            directory = optarg;
+            break;
+        case 't':
+            interval_ms = strtoull(optarg, NULL, 10);
+            break;
+        case 'n':
+            capacity = strtoull(optarg, NULL, 10);
+            break;
+        case 'o':
+            prefix = optarg;
+            break;
+        case 'H':
+            buffer_flags |= BUFFER_HUGE_PAGES;
+            break;
+        case 'L':
+            buffer_flags |= BUFFER_LOCKED;
+            break;
+        case 'z':
+            z_threshold = strtod(optarg, NULL);
+            break;
+        case 'x':
+            rerun_without_stragglers = true;
+            break;
+        default:
+            if (rank == 0) {
+                usage(argv[0]);
+            }
+            MPI_Finalize();
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    buffer_pool_set_flags(buffer_pool_shared(), buffer_flags);
+    env_report(directory, MPI_COMM_WORLD, NULL, stdout);
+
+    char file_name[256];
+    snprintf(file_name, sizeof(file_name), "%s/io_speed.%d", directory, rank);
+    size_t total_bytes = size_mib * M_SIZE;
+    size_t n_blocks = total_bytes / BLOCK_SIZE;
+
+    timeline_t tl;
+    int use_timeline = interval_ms > 0;
+    if (use_timeline) {
+        if (timeline_init(&tl, interval_ms * 1000000, capacity) != 0) {
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        io_tester_set_timeline(&tl);
+    }
+
+    double* all_bandwidth = rank == 0 ? calloc(size, sizeof(double)) : NULL;
+    char(*drain_hosts)[MPI_MAX_PROCESSOR_NAME] = calloc(size, MPI_MAX_PROCESSOR_NAME);
+    if (drain_hosts == NULL || (rank == 0 && all_bandwidth == NULL)) {
+        perror("Failed to allocate results");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    int n_drain_hosts = 0;
+    int status = EXIT_SUCCESS;
+    for (io_test_t test = SEQ_WRITE; test <= RAND_READ; test++) {
+        double bandwidth, aggregate;
+        if (run_on(test, file_name, n_blocks, MPI_COMM_WORLD, &bandwidth, &aggregate) != 0) {
+            status = EXIT_FAILURE;
+            break;
+        }
+        MPI_Gather(&bandwidth, 1, MPI_DOUBLE, all_bandwidth, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            for (int i = 0; i < size; i++) {
+                printf("Rank %d %s: %g MB/s\n", i, io_test_names[test], all_bandwidth[i]);
+            }
+            printf("Aggregate %s: %g MB/s\n", io_test_names[test], aggregate);
+        }
+        if (use_timeline) {
+            report_timeline(&tl, prefix, io_test_names[test], rank);
+        }
+
+        straggler_report_t report;
+        if (straggler_detect(bandwidth, true, z_threshold, MPI_COMM_WORLD, &report) != 0) {
+            if (rank == 0) {
+                log_error("Straggler detection of %s failed", io_test_names[test]);
+            }
+            status = EXIT_FAILURE;
+            break;
+        }
+        add_drain_hosts(&report, drain_hosts, &n_drain_hosts);
+        if (rank == 0) {
+            straggler_report_print(&report, io_test_names[test], stdout);
+        }
+        if (rerun_without_stragglers && report.n_stragglers > 0) {
+            MPI_Comm healthy;
+            straggler_exclude(&report, MPI_COMM_WORLD, &healthy);
+            // The timeline describes the run with all ranks.
+            io_tester_set_timeline(NULL);
+            int rerun_failed = 0;
+            if (healthy != MPI_COMM_NULL) {
+                int healthy_rank, healthy_size;
+                MPI_Comm_rank(healthy, &healthy_rank);
+                MPI_Comm_size(healthy, &healthy_size);
+                if (run_on(test, file_name, n_blocks, healthy, &bandwidth, &aggregate) != 0) {
+                    rerun_failed = 1;
+                } else if (healthy_rank == 0) {
+                    printf("Aggregate %s without stragglers (%d ranks): %g MB/s\n", io_test_names[test],
+                        healthy_size, aggregate);
+                }
+                MPI_Comm_free(&healthy);
+            }
+            io_tester_set_timeline(use_timeline ? &tl : NULL);
+            // Excluded ranks did not take part, so they learn about a failure here.
+            int any_rerun_failed = 0;
+            MPI_Allreduce(&rerun_failed, &any_rerun_failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+            if (any_rerun_failed) {
+                if (rank == 0) {
+                    log_error("Rerun of %s without stragglers failed", io_test_names[test]);
+                }
+                status = EXIT_FAILURE;
+            }
+        }
+        straggler_report_free(&report);
+    }
+    if (rank == 0 && n_drain_hosts > 0) {
+        printf("Drain candidates:");
+        for (int i = 0; i < n_drain_hosts; i++) {
+            printf(" %s", drain_hosts[i]);
+        }
+        printf("\n");
+    }
+
+    unlink(file_name);
+    if (use_timeline) {
+        io_tester_set_timeline(NULL);
+        timeline_free(&tl);
+    }
+    free(drain_hosts);
+    free(all_bandwidth);
+    buffer_pool_clear(buffer_pool_shared());
+    MPI_Finalize();
+    return status;
+}
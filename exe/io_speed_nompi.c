@@ -5,17 +5,94 @@
 // Enable POSIX extensions
 #define _POSIX_C_SOURCE 200809L // NOLINT
 
+#include "mpi_test_utils/buffer_pool.h"
 #include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
 #include "mpi_test_utils/io_tester.h"
+#include "mpi_test_utils/timeline.h"
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
 
-int main(void)
+static void report_timeline(const timeline_t* tl, const char* prefix, const char* test_name)
 {
+    if (tl == NULL) {
+        return;
+    }
+    if (tl->overflow) {
+        fprintf(stderr, "Timeline of %s ran out of its %zu intervals; the last one covers the rest of the test\n",
+            test_name, tl->capacity);
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s_%s.csv", prefix, test_name);
+    if (timeline_write_csv(path, tl->interval_ns, tl->bytes, tl->n_samples, tl->tail_ns) == 0) {
+        printf("Timeline of %s written to %s\n", test_name, path);
+    }
+    timeline_summarize(tl->interval_ns, tl->bytes, tl->n_samples, tl->tail_ns, stdout);
+}
+
+int main(int argc, char** argv)
+{
+    bool report_perf = false;
+    int buffer_flags = 0;
+    uint64_t interval_ms = 0;
+    size_t capacity = 36000;
+    const char* prefix = "timeline";
+    int opt;
+    while ((opt = getopt(argc, argv, "pHLt:n:o:h")) != -1) {
+        switch (opt) {
+        case 'p':
+            report_perf = true;
+            break;
+        case 't':
+            interval_ms = strtoull(optarg, NULL, 10);
+            break;
+        case 'n':
+            capacity = strtoull(optarg, NULL, 10);
+            break;
+        case 'o':
+            prefix = optarg;
+            break;
+        case 'H':
+            buffer_flags |= BUFFER_HUGE_PAGES;
+            break;
+        case 'L':
+            buffer_flags |= BUFFER_LOCKED;
+            break;
+        default:
+            fprintf(stderr,
+                "Usage: %s [-p] [-H] [-L] [-t interval ms] [-n max intervals] [-o prefix]\n"
+                "  -p  Report CPU, scheduler and storage counters of each test\n"
+                "  -t  Record bandwidth over time with this sampling interval\n"
+                "  -n  Capacity of the timeline in intervals (default 36000)\n"
+                "  -o  Prefix of timeline CSV files (default timeline)\n"
+                "  -H  Back I/O buffers with huge pages\n"
+                "  -L  mlock I/O buffers\n",
+                argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    io_tester_set_perf(report_perf);
+    buffer_pool_set_flags(buffer_pool_shared(), buffer_flags);
+    env_fingerprint_t env;
+    env_collect(&env, ".");
+    env_write(&env, "# ", stdout);
+
+    timeline_t timeline;
+    timeline_t* tl = NULL;
+    if (interval_ms > 0) {
+        if (timeline_init(&timeline, interval_ms * 1000000, capacity) != 0) {
+            return EXIT_FAILURE;
+        }
+        tl = &timeline;
+        io_tester_set_timeline(tl);
+    }
+
     size_t total_bytes = G_SIZE * 4; // 4 GB
     ssize_t sw_time = test_sequential_write_nompi("test", BLOCK_SIZE, total_bytes / BLOCK_SIZE);
     if (sw_time < 0) {
@@ -24,6 +101,10 @@ int main(void)
     }
     double sw_bandwidth = (double)total_bytes / (double)sw_time * 1e3; // bytes per ns convert to MB/s
     printf("Sequential Write Bandwidth: %.6f MB/s\n", sw_bandwidth);
+    if (report_perf) {
+        perf_sample_print(io_tester_last_perf(), stdout);
+    }
+    report_timeline(tl, prefix, "seq_write");
 
     ssize_t sr_time = test_sequential_read_nompi("test", BLOCK_SIZE, total_bytes / BLOCK_SIZE);
     if (sr_time < 0) {
@@ -32,6 +113,10 @@ int main(void)
     }
     double sr_bandwidth = (double)total_bytes / (double)sr_time * 1e3; // bytes per ns convert to MB/s
     printf("Sequential Read Bandwidth: %.6f MB/s\n", sr_bandwidth);
+    if (report_perf) {
+        perf_sample_print(io_tester_last_perf(), stdout);
+    }
+    report_timeline(tl, prefix, "seq_read");
 
     ssize_t rr_time = test_random_read_nompi("test", BLOCK_SIZE, total_bytes / BLOCK_SIZE, total_bytes / BLOCK_SIZE);
     if (rr_time < 0) {
@@ -40,7 +125,16 @@ int main(void)
     }
     double rr_bandwidth = (double)total_bytes / (double)rr_time * 1e3; // bytes per ns convert to MB/s
     printf("Random Read Bandwidth: %.6f MB/s\n", rr_bandwidth);
+    if (report_perf) {
+        perf_sample_print(io_tester_last_perf(), stdout);
+    }
+    report_timeline(tl, prefix, "rand_read");
 
     unlink("test");
+    if (tl != NULL) {
+        io_tester_set_timeline(NULL);
+        timeline_free(tl);
+    }
+    buffer_pool_clear(buffer_pool_shared());
     return EXIT_SUCCESS;
 }
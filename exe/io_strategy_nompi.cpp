@@ -0,0 +1,106 @@
+// Pick the fastest write engine for a given block size, as an application would at startup.
+
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/io_tester.hpp"
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace mtu = mpi_test_utils;
+
+namespace {
+
+struct candidate {
+    std::string name;
+    mtu::io_result result;
+};
+
+template <class Engine> candidate time_write(const mtu::io_config& config, mtu::buffer& buf)
+{
+    return { std::string(Engine::name) + " write", mtu::run<mtu::access::write, Engine>(config, buf) };
+}
+
+template <class Pattern> candidate time_read(const mtu::io_config& config, mtu::buffer& buf)
+{
+    return { std::string(Pattern::name) + " read",
+        mtu::run<mtu::access::read, mtu::pread_engine, Pattern>(config, buf) };
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    mtu::io_config config;
+    config.path = "test";
+    config.block_size = 1 << 20;
+    config.n_blocks = 256;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:b:n:h")) != -1) {
+        switch (opt) {
+        case 'f':
+            config.path = optarg;
+            break;
+        case 'b':
+            config.block_size = std::strtoull(optarg, nullptr, 10);
+            break;
+        case 'n':
+            config.n_blocks = std::strtoull(optarg, nullptr, 10);
+            break;
+        default:
+            std::fprintf(stderr,
+                "Usage: %s [-f file] [-b block size] [-n blocks]\n"
+                "  -f  Test file (default test)\n"
+                "  -b  Block size in bytes; a multiple of 4096 for O_DIRECT (default 1048576)\n"
+                "  -n  Blocks per test (default 256)\n",
+                argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    env_fingerprint_t env;
+    env_collect(&env, config.path.c_str());
+    env_write(&env, "# ", stdout);
+
+    int status = EXIT_SUCCESS;
+    try {
+        mtu::buffer buf(config.block_size);
+        // Every candidate ends with fdatasync inside its timed region, so that page-cached engines are compared
+        // with O_DSYNC and O_DIRECT on equal terms. Without it, the page cache would always win.
+        config.sync = true;
+        std::vector<candidate> writes;
+        writes.push_back({ "stdio write",
+            mtu::sequential_write_stdio_sync(
+                config.path, config.block_size, config.n_blocks, SYNC_FDATASYNC_EVERY_N, config.n_blocks) });
+        writes.push_back(time_write<mtu::pread_engine>(config, buf));
+        writes.push_back(time_write<mtu::dsync_engine>(config, buf));
+        try {
+            writes.push_back(time_write<mtu::direct_engine>(config, buf));
+        } catch (const mtu::io_error& e) {
+            // Not every filesystem supports O_DIRECT, e.g. tmpfs.
+            mtu::logging::warn(std::string("Skipping O_DIRECT: ") + e.what());
+        }
+        std::printf("Durable writes, each ending with fdatasync:\n");
+        const candidate* best = &writes.front();
+        for (const candidate& c : writes) {
+            std::printf("%s: %.6f MB/s\n", c.name.c_str(), c.result.mb_per_s());
+            best = c.result.mb_per_s() > best->result.mb_per_s() ? &c : best;
+        }
+        std::printf("Recommended: %s with %s-byte blocks\n", best->name.c_str(),
+            mtu::format_comma(config.block_size).c_str());
+
+        for (const candidate& c : { time_read<mtu::sequential_pattern>(config, buf),
+                 time_read<mtu::random_pattern>(config, buf) }) {
+            std::printf("%s: %.6f MB/s\n", c.name.c_str(), c.result.mb_per_s());
+        }
+    } catch (const mtu::io_error& e) {
+        mtu::logging::error(e.what());
+        status = EXIT_FAILURE;
+    }
+    unlink(config.path.c_str());
+    buffer_pool_clear(buffer_pool_shared());
+    return status;
+}
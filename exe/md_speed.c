@@ -0,0 +1,193 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/log.h"
+#include "mpi_test_utils/md_tester.h"
+#include "mpi_test_utils/stats.h"
+#include "mpi_test_utils/straggler.h"
+
+#include <mpi.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define N_QUANTILES 4
+
+static const double quantiles[N_QUANTILES] = { 0.5, 0.9, 0.99, 1.0 };
+static const char* quantile_names[N_QUANTILES] = { "p50", "p90", "p99", "max" };
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+        "Usage: %s [-n files per rank] [-d directory] [-u] [-o latency CSV]\n"
+        "  -n  Files created by each rank (default 10000)\n"
+        "  -d  Base directory (default .)\n"
+        "  -u  Use a unique directory per rank instead of one shared directory\n"
+        "  -o  Per-rank latency distribution output (default md_latency.csv)\n",
+        prog);
+}
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    size_t n_files = 10000;
+    const char* base_dir = ".";
+    int unique_dir = 0;
+    const char* csv_path = "md_latency.csv";
+    int opt;
+    while ((opt = getopt(argc, argv, "n:d:uo:h")) != -1) {
+        switch (opt) {
+        case 'n':
+            n_files = strtoull(optarg, NULL, 10);
+            break;
+        case 'd':
+            base_dir = optarg;
+            break;
+        case 'u':
+            unique_dir = 1;
+            break;
+        case 'o':
+            csv_path = optarg;
+            break;
+        default:
+            if (rank == 0) {
+                usage(argv[0]);
+            }
+            MPI_Finalize();
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    env_report(base_dir, MPI_COMM_WORLD, NULL, stdout);
+
+    char dir[4096];
+    char prefix[64];
+    if (unique_dir) {
+        snprintf(dir, sizeof(dir), "%s/md_rank.%d", base_dir, rank);
+    } else {
+        snprintf(dir, sizeof(dir), "%s/md_shared", base_dir);
+    }
+    snprintf(prefix, sizeof(prefix), "f.%d", rank);
+    if ((unique_dir || rank == 0) && mkdir(dir, S_IRWXU) != 0 && errno != EEXIST) {
+        perror("Failed to create test directory");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    if (rank == 0) {
+        log_info("Metadata test: %d ranks, %zu files per rank, %s directory", size, n_files,
+            unique_dir ? "unique" : "shared");
+    }
+
+    double* latencies_ns = calloc(n_files == 0 ? 1 : n_files, sizeof(double));
+    double* all_quantiles = rank == 0 ? calloc((size_t)size * N_QUANTILES, sizeof(double)) : NULL;
+    uint64_t* all_ops = rank == 0 ? calloc(size, sizeof(uint64_t)) : NULL;
+    double* column = rank == 0 ? calloc(size, sizeof(double)) : NULL;
+    if (latencies_ns == NULL || (rank == 0 && (all_quantiles == NULL || all_ops == NULL || column == NULL))) {
+        perror("Failed to allocate latency buffers");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    FILE* csv_file = NULL;
+    if (rank == 0) {
+        csv_file = fopen(csv_path, "we");
+        if (csv_file == NULL) {
+            perror("Failed to open CSV file for writing");
+        } else {
+            fprintf(csv_file, "phase,rank,ops,p50_us,p90_us,p99_us,max_us\n");
+        }
+    }
+
+    int status = EXIT_SUCCESS;
+    for (md_phase_t phase = MD_CREATE; phase < MD_N_PHASES; phase++) {
+        size_t n_ops = 0;
+        MPI_Barrier(MPI_COMM_WORLD);
+        ssize_t elapsed_ns = test_metadata_nompi(phase, dir, prefix, n_files, latencies_ns, &n_ops);
+        int failed = elapsed_ns < 0;
+        int any_failed = 0;
+        MPI_Allreduce(&failed, &any_failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+        if (any_failed) {
+            if (failed) {
+                log_error("Rank %d %s failed", rank, md_phase_name(phase));
+            }
+            status = EXIT_FAILURE;
+            break;
+        }
+
+        int64_t local_elapsed_ns = elapsed_ns;
+        int64_t max_elapsed_ns = 0;
+        uint64_t local_ops = n_ops;
+        uint64_t total_ops = 0;
+        MPI_Reduce(&local_elapsed_ns, &max_elapsed_ns, 1, MPI_INT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&local_ops, &total_ops, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+        size_t n_latencies = n_ops < n_files ? n_ops : n_files;
+        double local_quantiles[N_QUANTILES];
+        for (size_t q = 0; q < N_QUANTILES; q++) {
+            local_quantiles[q] = stats_quantile(latencies_ns, n_latencies, quantiles[q]) / 1e3;
+        }
+        MPI_Gather(local_quantiles, N_QUANTILES, MPI_DOUBLE, all_quantiles, N_QUANTILES, MPI_DOUBLE, 0,
+            MPI_COMM_WORLD);
+        MPI_Gather(&local_ops, 1, MPI_UINT64_T, all_ops, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+        straggler_report_t report;
+        double local_rate = elapsed_ns > 0 ? (double)n_ops / (double)elapsed_ns * 1e9 : NAN;
+        int straggler_status = straggler_detect(local_rate, true, STRAGGLER_DEFAULT_Z, MPI_COMM_WORLD, &report);
+        if (rank != 0) {
+            straggler_report_free(&report);
+            continue;
+        }
+
+        printf("%-10s %12.1f ops/s (%" PRIu64 " ops in %.3f s)\n", md_phase_name(phase),
+            (double)total_ops / (double)max_elapsed_ns * 1e9, total_ops, (double)max_elapsed_ns / 1e9);
+        // Distribution of each per-rank quantile across ranks.
+        for (size_t q = 0; q < N_QUANTILES; q++) {
+            int worst_rank = 0;
+            for (int r = 0; r < size; r++) {
+                column[r] = all_quantiles[r * N_QUANTILES + q];
+                if (column[r] > column[worst_rank]) {
+                    worst_rank = r;
+                }
+            }
+            printf("    %s latency: median rank %.2f us, worst rank %.2f us (rank %d)\n", quantile_names[q],
+                stats_median(column, size), column[worst_rank], worst_rank);
+        }
+        if (straggler_status == 0) {
+            straggler_report_print(&report, md_phase_name(phase), stdout);
+        }
+        straggler_report_free(&report);
+        if (csv_file != NULL) {
+            for (int r = 0; r < size; r++) {
+                const double* row = &all_quantiles[r * N_QUANTILES];
+                fprintf(csv_file, "%s,%d,%" PRIu64 ",%.3f,%.3f,%.3f,%.3f\n", md_phase_name(phase), r, all_ops[r],
+                    row[0], row[1], row[2], row[3]);
+            }
+        }
+    }
+
+    if (status != EXIT_SUCCESS) {
+        // Best-effort removal of files left over by a failed phase.
+        md_remove_files(dir, prefix, n_files);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (unique_dir || rank == 0) {
+        rmdir(dir);
+    }
+    if (csv_file != NULL) {
+        fclose(csv_file);
+        log_info("Per-rank latency distribution written to %s", csv_path);
+    }
+    free(column);
+    free(all_ops);
+    free(all_quantiles);
+    free(latencies_ns);
+    MPI_Finalize();
+    return status;
+}
@@ -0,0 +1,210 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/log.h"
+#include "mpi_test_utils/mem_tester.h"
+#include "mpi_test_utils/stats.h"
+#include "mpi_test_utils/straggler.h"
+#include "mpi_test_utils/topology.h"
+
+#include <mpi.h>
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+        "Usage: %s [-n elements] [-t threads] [-i iterations] [-u] [-a] [-T threshold] [-z threshold]\n"
+        "  -n  Doubles per array per thread (default 16777216, i.e. 128 MiB)\n"
+        "  -t  Threads per rank (default 1)\n"
+        "  -i  Iterations; the first one is warm-up (default 10)\n"
+        "  -u  Do not bind to NUMA nodes; run once with OS placement\n"
+        "  -a  Measure on every rank instead of one rank per host\n"
+        "  -T  Fraction below the other NUMA nodes of a host that is flagged (default 0.2)\n"
+        "  -z  Modified z-score above which a host is reported as a straggler (default 3.5)\n",
+        prog);
+}
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    stream_config_t config = { .n_elements = 16777216, .n_threads = 1, .n_iterations = 10, .numa_node = -1 };
+    bool bind = true;
+    bool all_ranks = false;
+    double threshold = 0.2;
+    double z_threshold = STRAGGLER_DEFAULT_Z;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:t:i:uaT:z:h")) != -1) {
+        switch (opt) {
+        case 'n':
+            config.n_elements = strtoull(optarg, NULL, 10);
+            break;
+        case 't':
+            config.n_threads = strtoull(optarg, NULL, 10);
+            break;
+        case 'i':
+            config.n_iterations = strtoull(optarg, NULL, 10);
+            break;
+        case 'u':
+            bind = false;
+            break;
+        case 'a':
+            all_ranks = true;
+            break;
+        case 'T':
+            threshold = strtod(optarg, NULL);
+            break;
+        case 'z':
+            z_threshold = strtod(optarg, NULL);
+            break;
+        default:
+            if (rank == 0) {
+                usage(argv[0]);
+            }
+            MPI_Finalize();
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    env_report(".", MPI_COMM_WORLD, NULL, stdout);
+
+    // Ranks sharing a host compete for the same memory controllers, so by default only one of them measures.
+    MPI_Comm host_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &host_comm);
+    int host_rank;
+    MPI_Comm_rank(host_comm, &host_rank);
+    MPI_Comm_free(&host_comm);
+    int measuring = all_ranks || host_rank == 0;
+
+    // Node IDs may be sparse; results are indexed by ID and nodes that were not measured stay 0.
+    int nodes[TOPOLOGY_MAX_NODES] = { 0 };
+    int n_nodes = bind ? topology_numa_nodes(nodes, TOPOLOGY_MAX_NODES) : 1;
+    int local_max_nodes = n_nodes > 0 ? nodes[n_nodes - 1] + 1 : 1;
+    int max_nodes = 0;
+    MPI_Allreduce(&local_max_nodes, &max_nodes, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    double* triad = calloc((size_t)max_nodes, sizeof(double));
+    if (triad == NULL) {
+        perror("Failed to allocate results");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    if (rank == 0) {
+        log_info("STREAM: %zu threads x %zu doubles per array, %s, %s", config.n_threads, config.n_elements,
+            bind ? "bound per NUMA node" : "unbound", all_ranks ? "all ranks" : "one rank per host");
+    }
+
+    int status = 0;
+    for (int i = 0; i < n_nodes && measuring && status == 0; i++) {
+        int node = nodes[i];
+        config.numa_node = bind ? node : -1;
+        stream_result_t result;
+        status = test_stream_nompi(&config, &result);
+        if (status != 0) {
+            stream_result_free(&result);
+            break;
+        }
+        triad[node] = result.best_mbps[STREAM_TRIAD];
+        for (stream_kernel_t kernel = STREAM_COPY; kernel < STREAM_N_KERNELS; kernel++) {
+            log_info("Rank %d node %d %s: %g MB/s", rank, config.numa_node, stream_kernel_name(kernel),
+                result.best_mbps[kernel]);
+        }
+        // A single slow thread, e.g. on a busy core, holds back the aggregate at every barrier.
+        for (size_t t = 0; t < result.n_threads && result.n_threads > 1; t++) {
+            const double* mbps = &result.thread_best_mbps[t * STREAM_N_KERNELS];
+            log_info("Rank %d node %d thread %zu: copy %g scale %g add %g triad %g MB/s", rank, config.numa_node, t,
+                mbps[STREAM_COPY], mbps[STREAM_SCALE], mbps[STREAM_ADD], mbps[STREAM_TRIAD]);
+        }
+        stream_result_free(&result);
+    }
+    int any_failed = 0;
+    MPI_Allreduce(&status, &any_failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+
+    char hostname[MPI_MAX_PROCESSOR_NAME] = { 0 };
+    int hostname_len;
+    MPI_Get_processor_name(hostname, &hostname_len);
+    double* all_triad = NULL;
+    char* all_hostnames = NULL;
+    int* all_measuring = NULL;
+    if (rank == 0) {
+        all_triad = calloc((size_t)size * (size_t)max_nodes, sizeof(double));
+        all_hostnames = calloc((size_t)size, MPI_MAX_PROCESSOR_NAME);
+        all_measuring = calloc((size_t)size, sizeof(int));
+        if (all_triad == NULL || all_hostnames == NULL || all_measuring == NULL) {
+            perror("Failed to allocate results");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+    }
+    MPI_Gather(triad, max_nodes, MPI_DOUBLE, all_triad, max_nodes, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Gather(hostname, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, all_hostnames, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, 0,
+        MPI_COMM_WORLD);
+    MPI_Gather(&measuring, 1, MPI_INT, all_measuring, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    // Best node of each rank, compared across ranks: a slow outlier points at degraded DIMMs.
+    double best = NAN;
+    for (int i = 0; i < n_nodes && measuring; i++) {
+        best = isnan(best) || triad[nodes[i]] > best ? triad[nodes[i]] : best;
+    }
+    straggler_report_t report;
+    int straggler_status = straggler_detect(best, true, z_threshold, MPI_COMM_WORLD, &report);
+
+    if (rank == 0 && !any_failed && straggler_status == 0) {
+        double* node_triad = calloc((size_t)max_nodes, sizeof(double));
+        if (node_triad == NULL) {
+            perror("Failed to allocate results");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        int n_measured = 0;
+        for (int r = 0; r < size; r++) {
+            n_measured += all_measuring[r];
+        }
+        printf("Median triad bandwidth: %g MB/s over %d ranks\n", report.median, n_measured);
+        straggler_report_print(&report, "triad MB/s", stdout);
+        size_t n_flagged = report.n_stragglers;
+        for (int r = 0; r < size; r++) {
+            if (!all_measuring[r]) {
+                continue;
+            }
+            const char* host = all_hostnames + (size_t)r * MPI_MAX_PROCESSOR_NAME;
+            // Within one host, NUMA nodes of the same hardware should perform alike.
+            size_t n_node_triad = 0;
+            for (int node = 0; node < max_nodes; node++) {
+                double value = all_triad[(size_t)r * (size_t)max_nodes + (size_t)node];
+                if (value > 0) {
+                    node_triad[n_node_triad++] = value;
+                }
+            }
+            double node_median = stats_median(node_triad, n_node_triad);
+            for (int node = 0; node < max_nodes; node++) {
+                double value = all_triad[(size_t)r * (size_t)max_nodes + (size_t)node];
+                if (value > 0 && value < node_median * (1.0 - threshold)) {
+                    printf("Rank %d (%s): NUMA node %d triad %g MB/s is %.1f%% below the other nodes; "
+                           "check DIMM population and NUMA configuration\n",
+                        r, host, node, value, (1.0 - value / node_median) * 100.0);
+                    n_flagged++;
+                }
+            }
+        }
+        if (n_flagged == 0) {
+            printf("No degraded hosts or NUMA nodes\n");
+        }
+        free(node_triad);
+    }
+    straggler_report_free(&report);
+
+    free(all_measuring);
+    free(all_hostnames);
+    free(all_triad);
+    free(triad);
+    MPI_Finalize();
+    return any_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/buffer_pool.h"
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/log.h"
+#include "mpi_test_utils/mixed_workload.h"
+#include "mpi_test_utils/stats.h"
+
+#include <mpi.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+        "Usage: %s [-t threads per rank] [-r read percent] [-T seconds] [-s MiB] [-b block KiB]\n"
+        "          [-n writes per sync] [-d directory] [-Q] [-D]\n"
+        "  -t  Reader or writer threads on each rank (default 1)\n"
+        "  -r  Share of reader ranks in percent (default 70)\n"
+        "  -T  Duration of each phase in seconds (default 10)\n"
+        "  -s  File size per rank in MiB (default 1024)\n"
+        "  -b  Block size in KiB (default 4)\n"
+        "  -n  Writers fdatasync after this many writes (default 0, never)\n"
+        "  -d  Directory of the per-rank files (default .)\n"
+        "  -Q  Sequential instead of random reads\n"
+        "  -D  Bypass the page cache with O_DIRECT\n",
+        prog);
+}
+
+// Sum the statistics of the members of one class on `root`. Other ranks pass empty statistics.
+static void reduce_class(const mixed_class_stats_t* local, mixed_class_stats_t* total, int root)
+{
+    uint64_t sums[3] = { local->n_threads, local->ops, local->bytes };
+    uint64_t total_sums[3] = { 0, 0, 0 };
+    uint64_t maxima[2] = { local->elapsed_ns, local->latency_ns.max };
+    uint64_t total_maxima[2] = { 0, 0 };
+    stats_hist_init(&total->latency_ns);
+    MPI_Reduce(sums, total_sums, 3, MPI_UINT64_T, MPI_SUM, root, MPI_COMM_WORLD);
+    MPI_Reduce(maxima, total_maxima, 2, MPI_UINT64_T, MPI_MAX, root, MPI_COMM_WORLD);
+    MPI_Reduce(local->latency_ns.counts, total->latency_ns.counts, STATS_HIST_BUCKETS, MPI_UINT64_T, MPI_SUM, root,
+        MPI_COMM_WORLD);
+    MPI_Reduce(&local->latency_ns.n, &total->latency_ns.n, 1, MPI_UINT64_T, MPI_SUM, root, MPI_COMM_WORLD);
+    MPI_Reduce(&local->latency_ns.sum, &total->latency_ns.sum, 1, MPI_DOUBLE, MPI_SUM, root, MPI_COMM_WORLD);
+    total->n_threads = total_sums[0];
+    total->ops = total_sums[1];
+    total->bytes = total_sums[2];
+    total->elapsed_ns = total_maxima[0];
+    total->latency_ns.max = total_maxima[1];
+}
+
+static void print_class(const char* label, int n_ranks, const mixed_class_stats_t* stats)
+{
+    if (stats->n_threads == 0) {
+        return;
+    }
+    const stats_hist_t* lat = &stats->latency_ns;
+    printf("%-14s %3d ranks %3zu threads %10.3f MB/s %10.1f ops/s  latency mean %.2f p50 %.2f p99 %.2f p99.9 %.2f "
+           "max %.2f us\n",
+        label, n_ranks, stats->n_threads, (double)stats->bytes / (double)stats->elapsed_ns * 1e3,
+        (double)stats->ops / (double)stats->elapsed_ns * 1e9, stats_hist_mean(lat) / 1e3,
+        stats_hist_quantile(lat, 0.5) / 1e3, stats_hist_quantile(lat, 0.99) / 1e3,
+        stats_hist_quantile(lat, 0.999) / 1e3, (double)lat->max / 1e3);
+}
+
+// Run one phase on every rank, with readers only if `with_writers` is false, and reduce statistics per class.
+static int run_phase(const mixed_config_t* config, bool is_writer, bool with_writers, mixed_class_stats_t* read_stats,
+    mixed_class_stats_t* write_stats)
+{
+    mixed_class_stats_t local_read = { 0 };
+    mixed_class_stats_t local_write = { 0 };
+    stats_hist_init(&local_read.latency_ns);
+    stats_hist_init(&local_write.latency_ns);
+    int failed = 0;
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (!is_writer || with_writers) {
+        failed = test_mixed_nompi(config, &local_read, &local_write) != 0;
+    }
+    int any_failed = 0;
+    MPI_Allreduce(&failed, &any_failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+    if (any_failed) {
+        return -1;
+    }
+    reduce_class(&local_read, read_stats, 0);
+    reduce_class(&local_write, write_stats, 0);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    size_t n_threads = 1;
+    unsigned read_percent = 70;
+    double duration_s = 10.0;
+    size_t size_mib = 1024;
+    size_t block_size = BLOCK_SIZE;
+    size_t sync_interval = 0;
+    const char* dir = ".";
+    bool random_reads = true;
+    bool direct = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:r:T:s:b:n:d:QDh")) != -1) {
+        switch (opt) {
+        case 't':
+            n_threads = strtoull(optarg, NULL, 10);
+            break;
+        case 'r':
+            read_percent = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'T':
+            duration_s = strtod(optarg, NULL);
+            break;
+        case 's':
+            size_mib = strtoull(optarg, NULL, 10);
+            break;
+        case 'b':
+            block_size = strtoull(optarg, NULL, 10) * K_SIZE;
+            break;
+        case 'n':
+            sync_interval = strtoull(optarg, NULL, 10);
+            break;
+        case 'd':
+            dir = optarg;
+            break;
+        case 'Q':
+            random_reads = false;
+            break;
+        case 'D':
+            direct = true;
+            break;
+        default:
+            if (rank == 0) {
+                usage(argv[0]);
+            }
+            MPI_Finalize();
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (provided < MPI_THREAD_FUNNELED || n_threads == 0 || read_percent > 100 || block_size == 0
+        || !(duration_s > 0)) {
+        if (rank == 0) {
+            fprintf(stderr, "Invalid thread count, read percentage, block size or duration, "
+                            "or MPI lacks MPI_THREAD_FUNNELED\n");
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    env_report(dir, MPI_COMM_WORLD, NULL, stdout);
+
+    // The first ranks read, the rest write, at the requested ratio.
+    size_t n_reader_ranks, n_writer_ranks;
+    mixed_split_threads((size_t)size, read_percent, &n_reader_ranks, &n_writer_ranks);
+    bool is_writer = (size_t)rank >= n_reader_ranks;
+    char file_name[4096];
+    snprintf(file_name, sizeof(file_name), "%s/mixed_%s.%d", dir, is_writer ? "write" : "read", rank);
+    mixed_config_t config = {
+        .read_file = file_name,
+        .write_file = file_name,
+        .block_size = block_size,
+        .file_blocks = size_mib * M_SIZE / block_size,
+        .n_readers = is_writer ? 0 : n_threads,
+        .n_writers = is_writer ? n_threads : 0,
+        .duration_ns = (uint64_t)(duration_s * 1e9),
+        .random_reads = random_reads,
+        .direct = direct,
+        .sync_interval = sync_interval,
+    };
+    if (rank == 0) {
+        log_info("Mixed workload: %zu reader ranks, %zu writer ranks, %zu threads each", n_reader_ranks,
+            n_writer_ranks, n_threads);
+    }
+
+    mixed_class_stats_t read_stats, write_stats;
+    int status = EXIT_SUCCESS;
+    // Readers alone first, so the interference of writer ranks on read latency can be quantified.
+    mixed_class_stats_t isolated_read_stats = { 0 };
+    if (n_reader_ranks > 0 && n_writer_ranks > 0) {
+        if (run_phase(&config, is_writer, false, &isolated_read_stats, &write_stats) != 0) {
+            if (rank == 0) {
+                log_error("Isolated read phase failed");
+            }
+            status = EXIT_FAILURE;
+        } else if (rank == 0) {
+            print_class("read isolated", (int)n_reader_ranks, &isolated_read_stats);
+        }
+    }
+
+    if (status == EXIT_SUCCESS) {
+        if (run_phase(&config, is_writer, true, &read_stats, &write_stats) != 0) {
+            if (rank == 0) {
+                log_error("Mixed phase failed");
+            }
+            status = EXIT_FAILURE;
+        } else if (rank == 0) {
+            print_class("read mixed", (int)n_reader_ranks, &read_stats);
+            print_class("write mixed", (int)n_writer_ranks, &write_stats);
+            if (isolated_read_stats.n_threads > 0 && isolated_read_stats.latency_ns.n > 0) {
+                printf("Read latency inflation under writer ranks: p50 x%.2f, p99 x%.2f\n",
+                    stats_hist_quantile(&read_stats.latency_ns, 0.5)
+                        / stats_hist_quantile(&isolated_read_stats.latency_ns, 0.5),
+                    stats_hist_quantile(&read_stats.latency_ns, 0.99)
+                        / stats_hist_quantile(&isolated_read_stats.latency_ns, 0.99));
+            }
+        }
+    }
+    unlink(file_name);
+    buffer_pool_clear(buffer_pool_shared());
+    MPI_Finalize();
+    return status;
+}
@@ -0,0 +1,145 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/mixed_workload.h"
+#include "mpi_test_utils/stats.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void print_class(const char* label, const mixed_class_stats_t* stats)
+{
+    if (stats->n_threads == 0) {
+        return;
+    }
+    const stats_hist_t* lat = &stats->latency_ns;
+    printf("%-14s %2zu threads %10.3f MB/s %10.1f ops/s  latency mean %.2f p50 %.2f p99 %.2f p99.9 %.2f max %.2f us\n",
+        label, stats->n_threads, (double)stats->bytes / (double)stats->elapsed_ns * 1e3,
+        (double)stats->ops / (double)stats->elapsed_ns * 1e9, stats_hist_mean(lat) / 1e3,
+        stats_hist_quantile(lat, 0.5) / 1e3, stats_hist_quantile(lat, 0.99) / 1e3,
+        stats_hist_quantile(lat, 0.999) / 1e3, (double)lat->max / 1e3);
+}
+
+int main(int argc, char** argv)
+{
+    const char* read_file = "mixed_read";
+    const char* write_file = "mixed_write";
+    size_t n_threads = 4;
+    unsigned read_percent = 70;
+    double duration_s = 10.0;
+    size_t size_mib = 1024;
+    size_t block_size = BLOCK_SIZE;
+    bool shared_file = false;
+    bool random_reads = true;
+    bool direct = false;
+    size_t sync_interval = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:r:T:s:b:n:SQDh")) != -1) {
+        switch (opt) {
+        case 't':
+            n_threads = strtoull(optarg, NULL, 10);
+            break;
+        case 'r':
+            read_percent = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'T':
+            duration_s = strtod(optarg, NULL);
+            break;
+        case 's':
+            size_mib = strtoull(optarg, NULL, 10);
+            break;
+        case 'b':
+            block_size = strtoull(optarg, NULL, 10) * K_SIZE;
+            break;
+        case 'n':
+            sync_interval = strtoull(optarg, NULL, 10);
+            break;
+        case 'S':
+            shared_file = true;
+            break;
+        case 'Q':
+            random_reads = false;
+            break;
+        case 'D':
+            direct = true;
+            break;
+        default:
+            fprintf(stderr,
+                "Usage: %s [-t threads] [-r read percent] [-T seconds] [-s MiB] [-b block KiB] [-n writes per sync]"
+                " [-S] [-Q] [-D]\n"
+                "  -t  Total reader and writer threads (default 4)\n"
+                "  -r  Share of reader threads in percent (default 70)\n"
+                "  -T  Duration of each phase in seconds (default 10)\n"
+                "  -s  File size in MiB (default 1024)\n"
+                "  -b  Block size in KiB (default 4)\n"
+                "  -n  Writers fdatasync after this many writes (default 0, never)\n"
+                "  -S  Readers and writers share one file\n"
+                "  -Q  Sequential instead of random reads\n"
+                "  -D  Bypass the page cache with O_DIRECT\n",
+                argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (read_percent > 100 || block_size == 0 || !(duration_s > 0)) {
+        fprintf(stderr, "Invalid read percentage, block size or duration\n");
+        return EXIT_FAILURE;
+    }
+    env_fingerprint_t env;
+    env_collect(&env, read_file);
+    env_write(&env, "# ", stdout);
+
+    mixed_config_t config = {
+        .read_file = read_file,
+        .write_file = shared_file ? read_file : write_file,
+        .block_size = block_size,
+        .file_blocks = size_mib * M_SIZE / block_size,
+        .duration_ns = (uint64_t)(duration_s * 1e9),
+        .random_reads = random_reads,
+        .direct = direct,
+        .sync_interval = sync_interval,
+    };
+    mixed_split_threads(n_threads, read_percent, &config.n_readers, &config.n_writers);
+    size_t n_writers = config.n_writers;
+    mixed_class_stats_t read_stats, write_stats;
+    int status = EXIT_SUCCESS;
+
+    // Readers alone first, so the interference of writers on read latency can be quantified.
+    mixed_class_stats_t isolated_read_stats = { 0 };
+    if (config.n_readers > 0 && n_writers > 0) {
+        config.n_writers = 0;
+        if (test_mixed_nompi(&config, &isolated_read_stats, &write_stats) != 0) {
+            fprintf(stderr, "Isolated read phase failed\n");
+            status = EXIT_FAILURE;
+        }
+        print_class("read isolated", &isolated_read_stats);
+        config.n_writers = n_writers;
+    }
+
+    if (status == EXIT_SUCCESS) {
+        if (test_mixed_nompi(&config, &read_stats, &write_stats) != 0) {
+            fprintf(stderr, "Mixed phase failed\n");
+            status = EXIT_FAILURE;
+        } else {
+            print_class("read mixed", &read_stats);
+            print_class("write mixed", &write_stats);
+            if (isolated_read_stats.n_threads > 0 && isolated_read_stats.latency_ns.n > 0) {
+                printf("Read latency inflation under writers: p50 x%.2f, p99 x%.2f\n",
+                    stats_hist_quantile(&read_stats.latency_ns, 0.5)
+                        / stats_hist_quantile(&isolated_read_stats.latency_ns, 0.5),
+                    stats_hist_quantile(&read_stats.latency_ns, 0.99)
+                        / stats_hist_quantile(&isolated_read_stats.latency_ns, 0.99));
+            }
+        }
+    }
+    unlink(read_file);
+    if (!shared_file) {
+        unlink(write_file);
+    }
+    return status;
+}
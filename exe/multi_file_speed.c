@@ -0,0 +1,249 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/buffer_pool.h"
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/log.h"
+#include "mpi_test_utils/multi_file.h"
+#include "mpi_test_utils/straggler.h"
+
+#include <mpi.h>
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_DIRS 64
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+        "Usage: %s [-d dir,dir,...] [-k files] [-s MiB] [-b KiB] [-c count] [-S KiB] [-N] [-F] [-o CSV]\n"
+        "          [-z threshold]\n"
+        "  -d  Comma-separated target directories (default .)\n"
+        "  -k  Files written concurrently by each rank, one thread each (default 4)\n"
+        "  -s  Size of each file in MiB (default 256)\n"
+        "  -b  Block size in KiB (default 1024)\n"
+        "  -c  Lustre stripe count of each file (default: directory layout)\n"
+        "  -S  Lustre stripe size in KiB (default: directory layout)\n"
+        "  -N  Do not fdatasync written files\n"
+        "  -F  Only run with all targets and files instead of sweeping both counts in powers of two\n"
+        "  -o  Write the scaling table as CSV\n"
+        "  -z  Modified z-score above which a rank is reported as a straggler (default 3.5)\n",
+        prog);
+}
+
+// Powers of two below `max`, then `max` itself.
+static size_t next_count(size_t count, size_t max) { return count * 2 < max ? count * 2 : max; }
+
+// Collective. Aggregate bandwidth in MB/s on rank 0, or -1 on every rank if any rank failed.
+// `report` receives the ranks whose own bandwidth lags behind the others and must be freed either way.
+static double aggregate_mbps(
+    ssize_t elapsed_ns, uint64_t bytes, const char* what, double z_threshold, straggler_report_t* report)
+{
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    memset(report, 0, sizeof(straggler_report_t));
+    int failed = elapsed_ns < 0;
+    int any_failed = 0;
+    MPI_Allreduce(&failed, &any_failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+    if (any_failed) {
+        if (failed) {
+            log_error("Rank %d %s failed", rank, what);
+        }
+        return -1.0;
+    }
+    int64_t local_elapsed_ns = elapsed_ns;
+    int64_t max_elapsed_ns = 0;
+    uint64_t total_bytes = 0;
+    MPI_Reduce(&local_elapsed_ns, &max_elapsed_ns, 1, MPI_INT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&bytes, &total_bytes, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+    double local_mbps = elapsed_ns > 0 ? (double)bytes / (double)elapsed_ns * 1e3 : NAN;
+    if (straggler_detect(local_mbps, true, z_threshold, MPI_COMM_WORLD, report) != 0) {
+        if (rank == 0) {
+            log_error("Straggler detection of %s failed", what);
+        }
+        return -1.0;
+    }
+    return max_elapsed_ns > 0 ? (double)total_bytes / (double)max_elapsed_ns * 1e3 : 0.0;
+}
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    char* dir_list = NULL;
+    multi_file_config_t config = { .n_files = 4, .file_size = 256 * M_SIZE, .block_size = M_SIZE, .sync = true };
+    bool sweep = true;
+    const char* csv_path = NULL;
+    double z_threshold = STRAGGLER_DEFAULT_Z;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:k:s:b:c:S:NFo:z:h")) != -1) {
+        switch (opt) {
+        case 'd':
+            dir_list = optarg;
+            break;
+        case 'k':
+            config.n_files = strtoull(optarg, NULL, 10);
+            break;
+        case 's':
+            config.file_size = strtoull(optarg, NULL, 10) * M_SIZE;
+            break;
+        case 'b':
+            config.block_size = strtoull(optarg, NULL, 10) * K_SIZE;
+            break;
+        case 'c':
+            config.stripe_count = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'S':
+            config.stripe_size = strtoull(optarg, NULL, 10) * K_SIZE;
+            break;
+        case 'N':
+            config.sync = false;
+            break;
+        case 'F':
+            sweep = false;
+            break;
+        case 'o':
+            csv_path = optarg;
+            break;
+        case 'z':
+            z_threshold = strtod(optarg, NULL);
+            break;
+        default:
+            if (rank == 0) {
+                usage(argv[0]);
+            }
+            MPI_Finalize();
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    const char* dirs[MAX_DIRS] = { "." };
+    size_t n_dirs = 1;
+    if (dir_list != NULL) {
+        n_dirs = 0;
+        for (char* dir = strtok(dir_list, ","); dir != NULL; dir = strtok(NULL, ",")) {
+            if (n_dirs == MAX_DIRS) {
+                if (rank == 0) {
+                    fprintf(stderr, "At most %d directories are supported\n", MAX_DIRS);
+                }
+                MPI_Finalize();
+                return EXIT_FAILURE;
+            }
+            dirs[n_dirs++] = dir;
+        }
+    }
+    if (n_dirs == 0 || config.n_files == 0 || config.block_size == 0) {
+        if (rank == 0) {
+            fprintf(stderr, "Need at least one directory, one file and a non-zero block size\n");
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+    config.dirs = dirs;
+
+    env_report(dirs[0], MPI_COMM_WORLD, NULL, stdout);
+    FILE* csv_file = NULL;
+    if (rank == 0) {
+        log_info("Multi-file test: %d ranks, up to %zu files per rank of %zu MiB over up to %zu targets", size,
+            config.n_files, config.file_size / M_SIZE, n_dirs);
+        if (csv_path != NULL) {
+            csv_file = fopen(csv_path, "we");
+            if (csv_file == NULL) {
+                perror("Failed to open CSV file for writing");
+            } else {
+                fprintf(csv_file, "targets,files_per_rank,files,write_mbps,read_mbps\n");
+            }
+        }
+        printf("%8s %10s %8s %14s %8s %14s %8s\n", "targets", "files/rank", "files", "write MB/s", "scaling",
+            "read MB/s", "scaling");
+    }
+
+    size_t max_files = config.n_files;
+    bool hints = config.stripe_count != 0 || config.stripe_size != 0;
+    bool hints_checked = false;
+    double base_write = 0.0;
+    double base_read = 0.0;
+    int status = EXIT_SUCCESS;
+    for (size_t n_targets = sweep ? 1 : n_dirs; status == EXIT_SUCCESS; n_targets = next_count(n_targets, n_dirs)) {
+        for (size_t k = sweep ? 1 : max_files; status == EXIT_SUCCESS; k = next_count(k, max_files)) {
+            config.n_dirs = n_targets;
+            config.n_files = k;
+            config.first_index = (size_t)rank * k;
+            uint64_t bytes = (uint64_t)k * config.file_size;
+
+            size_t n_striped = 0;
+            MPI_Barrier(MPI_COMM_WORLD);
+            ssize_t write_ns = test_multi_file_write_nompi(&config, &n_striped);
+            straggler_report_t write_report, read_report;
+            double write_mbps = aggregate_mbps(write_ns, bytes, "write", z_threshold, &write_report);
+            if (hints && !hints_checked) {
+                uint64_t local_striped = n_striped;
+                uint64_t total_striped = 0;
+                MPI_Reduce(&local_striped, &total_striped, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+                if (rank == 0 && total_striped < (uint64_t)size * k) {
+                    log_warn("Stripe hints applied to %" PRIu64 " of %zu files; the targets may not be Lustre",
+                        total_striped, (size_t)size * k);
+                }
+                hints_checked = true;
+            }
+            MPI_Barrier(MPI_COMM_WORLD);
+            ssize_t read_ns = write_mbps < 0 ? -1 : test_multi_file_read_nompi(&config);
+            memset(&read_report, 0, sizeof(straggler_report_t));
+            double read_mbps
+                = write_mbps < 0 ? -1.0 : aggregate_mbps(read_ns, bytes, "read", z_threshold, &read_report);
+            multi_file_remove(&config);
+            if (write_mbps < 0 || read_mbps < 0) {
+                straggler_report_free(&write_report);
+                straggler_report_free(&read_report);
+                status = EXIT_FAILURE;
+                break;
+            }
+
+            if (rank == 0) {
+                if (base_write == 0.0) {
+                    base_write = write_mbps;
+                    base_read = read_mbps;
+                }
+                printf("%8zu %10zu %8zu %14.1f %7.2fx %14.1f %7.2fx\n", n_targets, k, (size_t)size * k, write_mbps,
+                    base_write > 0 ? write_mbps / base_write : 0.0, read_mbps,
+                    base_read > 0 ? read_mbps / base_read : 0.0);
+                if (csv_file != NULL) {
+                    fprintf(csv_file, "%zu,%zu,%zu,%.3f,%.3f\n", n_targets, k, (size_t)size * k, write_mbps,
+                        read_mbps);
+                }
+                char metric[64];
+                snprintf(metric, sizeof(metric), "write MB/s (%zu targets, %zu files/rank)", n_targets, k);
+                straggler_report_print(&write_report, metric, stdout);
+                snprintf(metric, sizeof(metric), "read MB/s (%zu targets, %zu files/rank)", n_targets, k);
+                straggler_report_print(&read_report, metric, stdout);
+            }
+            straggler_report_free(&write_report);
+            straggler_report_free(&read_report);
+            if (k == max_files) {
+                break;
+            }
+        }
+        if (n_targets == n_dirs) {
+            break;
+        }
+    }
+
+    if (csv_file != NULL) {
+        fclose(csv_file);
+        log_info("Scaling table written to %s", csv_path);
+    }
+    buffer_pool_clear(buffer_pool_shared());
+    MPI_Finalize();
+    return status;
+}
@@ -0,0 +1,331 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/buffer_pool.h"
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/io_engines.h"
+#include "mpi_test_utils/log.h"
+#include "mpi_test_utils/straggler.h"
+
+#include <mpi.h>
+
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Exchanges between two agreements on whether to stop. Keeps the collective out of the steady state.
+#define CHECK_INTERVAL 8
+
+typedef struct {
+    char* send;
+    char* recv_left;
+    char* recv_right;
+    size_t message_size;
+    int left;
+    int right;
+} exchange_t;
+
+typedef struct {
+    uint64_t bytes;
+    int64_t elapsed_ns;
+} phase_result_t;
+
+typedef struct {
+    const char* file_name;
+    const io_engine_config_t* config;
+    bool write;
+    size_t file_size;
+    uint64_t bytes;
+    ssize_t elapsed_ns;
+    atomic_bool done;
+    pthread_t tid;
+} io_thread_t;
+
+typedef struct {
+    int64_t duration_ns;
+    const atomic_bool* io_done;
+} stop_condition_t;
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+        "Usage: %s [-d dir] [-T seconds] [-m KiB] [-e engine] [-b KiB] [-t threads] [-q depth] [-s MiB] [-N]\n"
+        "          [-z threshold]\n"
+        "  -d  Directory of the per-rank test files (default .)\n"
+        "  -T  Duration of the isolated MPI phase in seconds (default 10)\n"
+        "  -m  Message size of the neighbour exchange in KiB (default 1024)\n"
+        "  -e  I/O engine: stdio, pread, direct, mmap or aio (default pread)\n"
+        "  -b  I/O block size in KiB (default 1024)\n"
+        "  -t  I/O threads per rank (default 1)\n"
+        "  -q  Queue depth of the aio engine (default 8)\n"
+        "  -s  Data written and read by each rank in MiB (default 4096)\n"
+        "  -N  Do not fdatasync written data\n"
+        "  -z  Modified z-score above which a rank is reported as a straggler (default 3.5)\n",
+        prog);
+}
+
+// Send to both ring neighbours and receive from both.
+static void exchange(const exchange_t* ex)
+{
+    MPI_Request requests[4];
+    int count = (int)ex->message_size;
+    MPI_Irecv(ex->recv_left, count, MPI_BYTE, ex->left, 0, MPI_COMM_WORLD, &requests[0]);
+    MPI_Irecv(ex->recv_right, count, MPI_BYTE, ex->right, 1, MPI_COMM_WORLD, &requests[1]);
+    MPI_Isend(ex->send, count, MPI_BYTE, ex->right, 0, MPI_COMM_WORLD, &requests[2]);
+    MPI_Isend(ex->send, count, MPI_BYTE, ex->left, 1, MPI_COMM_WORLD, &requests[3]);
+    MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+}
+
+// Collective. Exchange until all ranks agree to stop: after the duration when running alone,
+// or once the I/O of every rank is done when overlapped.
+static phase_result_t run_exchange(const exchange_t* ex, const stop_condition_t* stop)
+{
+    phase_result_t result = { 0, 0 };
+    int64_t start = now_ns();
+    for (uint64_t i = 1;; i++) {
+        exchange(ex);
+        result.bytes += 2 * (uint64_t)ex->message_size;
+        if (i % CHECK_INTERVAL != 0) {
+            continue;
+        }
+        int local_stop = stop->io_done != NULL ? atomic_load(stop->io_done) : now_ns() - start >= stop->duration_ns;
+        int all_stop = 0;
+        MPI_Allreduce(&local_stop, &all_stop, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+        if (all_stop) {
+            break;
+        }
+    }
+    result.elapsed_ns = now_ns() - start;
+    return result;
+}
+
+static void* io_thread_main(void* arg)
+{
+    io_thread_t* io = arg;
+    io->elapsed_ns = test_engine_nompi(io->file_name, io->config, io->write, io->file_size, &io->bytes);
+    atomic_store(&io->done, true);
+    return NULL;
+}
+
+// Make reads hit storage. The file was synced after writing unless -N was given.
+static void drop_cache(const char* file_name)
+{
+    int fd = open(file_name, O_RDONLY | O_CLOEXEC);
+    if (fd != -1) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+static void prepare_io(io_thread_t* io, bool write)
+{
+    io->write = write;
+    io->bytes = 0;
+    io->elapsed_ns = -1;
+    atomic_init(&io->done, false);
+    if (!write) {
+        drop_cache(io->file_name);
+    }
+}
+
+// Collective. Aggregate bandwidth in MB/s on rank 0: all bytes over the longest elapsed time.
+// Ranks whose own bandwidth lags behind are reported under `metric`. Returns -1 on every rank if any rank failed.
+static double aggregate_mbps(phase_result_t result, bool failed, const char* metric, double z_threshold)
+{
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    int local_failed = failed;
+    int any_failed = 0;
+    MPI_Allreduce(&local_failed, &any_failed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+    if (any_failed) {
+        return -1.0;
+    }
+    int64_t max_elapsed_ns = 0;
+    uint64_t total_bytes = 0;
+    MPI_Reduce(&result.elapsed_ns, &max_elapsed_ns, 1, MPI_INT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&result.bytes, &total_bytes, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+    double local_mbps = result.elapsed_ns > 0 ? (double)result.bytes / (double)result.elapsed_ns * 1e3 : NAN;
+    straggler_report_t report;
+    if (straggler_detect(local_mbps, true, z_threshold, MPI_COMM_WORLD, &report) != 0) {
+        if (rank == 0) {
+            log_error("Straggler detection of %s failed", metric);
+        }
+        return -1.0;
+    }
+    if (rank == 0) {
+        straggler_report_print(&report, metric, stdout);
+    }
+    straggler_report_free(&report);
+    return max_elapsed_ns > 0 ? (double)total_bytes / (double)max_elapsed_ns * 1e3 : 0.0;
+}
+
+static void print_change(const char* label, double overlapped, double alone)
+{
+    printf("%-28s %12.1f MB/s (%+.1f%% vs alone)\n", label, overlapped,
+        alone > 0 ? (overlapped / alone - 1.0) * 100.0 : 0.0);
+}
+
+int main(int argc, char** argv)
+{
+    // Only the main thread calls MPI; I/O threads never do.
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    const char* dir = ".";
+    double duration_s = 10.0;
+    size_t message_size = M_SIZE;
+    size_t file_size = 4 * G_SIZE;
+    io_engine_config_t io_config
+        = { .engine = IO_ENGINE_PREAD, .block_size = M_SIZE, .queue_depth = 8, .n_threads = 1, .sync = true };
+    double z_threshold = STRAGGLER_DEFAULT_Z;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:T:m:e:b:t:q:s:Nz:h")) != -1) {
+        switch (opt) {
+        case 'd':
+            dir = optarg;
+            break;
+        case 'T':
+            duration_s = strtod(optarg, NULL);
+            break;
+        case 'm':
+            message_size = strtoull(optarg, NULL, 10) * K_SIZE;
+            break;
+        case 'e':
+            io_config.engine = io_engine_parse(optarg);
+            break;
+        case 'b':
+            io_config.block_size = strtoull(optarg, NULL, 10) * K_SIZE;
+            break;
+        case 't':
+            io_config.n_threads = strtoull(optarg, NULL, 10);
+            break;
+        case 'q':
+            io_config.queue_depth = strtoull(optarg, NULL, 10);
+            break;
+        case 's':
+            file_size = strtoull(optarg, NULL, 10) * M_SIZE;
+            break;
+        case 'N':
+            io_config.sync = false;
+            break;
+        case 'z':
+            z_threshold = strtod(optarg, NULL);
+            break;
+        default:
+            if (rank == 0) {
+                usage(argv[0]);
+            }
+            MPI_Finalize();
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (provided < MPI_THREAD_FUNNELED || io_config.engine == IO_ENGINE_N || message_size == 0
+        || message_size > INT32_MAX) {
+        if (rank == 0) {
+            fprintf(stderr, "Invalid engine or message size, or MPI lacks MPI_THREAD_FUNNELED\n");
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    env_report(dir, MPI_COMM_WORLD, NULL, stdout);
+    buffer_t messages;
+    if (buffer_alloc(&messages, 3 * message_size, 0) != 0) {
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    exchange_t ex = {
+        .send = messages.data,
+        .recv_left = (char*)messages.data + message_size,
+        .recv_right = (char*)messages.data + 2 * message_size,
+        .message_size = message_size,
+        .left = (rank + size - 1) % size,
+        .right = (rank + 1) % size,
+    };
+    char file_name[4096];
+    snprintf(file_name, sizeof(file_name), "%s/overlap.%d", dir, rank);
+    io_thread_t io = { .file_name = file_name, .config = &io_config, .file_size = file_size };
+    if (rank == 0) {
+        log_info("Overlap test: %d ranks, %zu KiB ring exchange, %s I/O with %zu threads of %zu KiB blocks, "
+                 "%zu MiB per rank",
+            size, message_size / K_SIZE, io_engine_name(io_config.engine), io_config.n_threads,
+            io_config.block_size / K_SIZE, file_size / M_SIZE);
+    }
+
+    // Isolated baselines.
+    stop_condition_t timed = { .duration_ns = (int64_t)(duration_s * 1e9), .io_done = NULL };
+    MPI_Barrier(MPI_COMM_WORLD);
+    double mpi_alone = aggregate_mbps(run_exchange(&ex, &timed), false, "MPI exchange alone MB/s", z_threshold);
+    double io_alone[2];
+    for (int write = 1; write >= 0; write--) {
+        prepare_io(&io, write);
+        MPI_Barrier(MPI_COMM_WORLD);
+        io_thread_main(&io);
+        io_alone[write] = aggregate_mbps((phase_result_t) { io.bytes, io.elapsed_ns }, io.elapsed_ns < 0,
+            write ? "write alone MB/s" : "read alone MB/s", z_threshold);
+    }
+
+    // Overlapped: the exchange runs until the I/O of every rank is done.
+    double mpi_overlapped[2];
+    double io_overlapped[2];
+    for (int write = 1; write >= 0; write--) {
+        prepare_io(&io, write);
+        stop_condition_t overlapped = { .io_done = &io.done };
+        MPI_Barrier(MPI_COMM_WORLD);
+        bool started = pthread_create(&io.tid, NULL, io_thread_main, &io) == 0;
+        if (!started) {
+            perror("Failed to create I/O thread");
+            atomic_store(&io.done, true);
+        }
+        phase_result_t mpi_result = run_exchange(&ex, &overlapped);
+        if (started) {
+            pthread_join(io.tid, NULL);
+        }
+        mpi_overlapped[write] = aggregate_mbps(mpi_result, false,
+            write ? "MPI exchange during write MB/s" : "MPI exchange during read MB/s", z_threshold);
+        io_overlapped[write] = aggregate_mbps((phase_result_t) { io.bytes, io.elapsed_ns },
+            !started || io.elapsed_ns < 0, write ? "write during MPI exchange MB/s" : "read during MPI exchange MB/s",
+            z_threshold);
+    }
+    unlink(file_name);
+
+    int status = EXIT_SUCCESS;
+    if (rank == 0) {
+        if (mpi_alone < 0 || mpi_overlapped[0] < 0 || mpi_overlapped[1] < 0 || io_alone[0] < 0 || io_alone[1] < 0
+            || io_overlapped[0] < 0 || io_overlapped[1] < 0) {
+            log_error("I/O or straggler detection failed on at least one rank");
+            status = EXIT_FAILURE;
+        } else {
+            printf("%-28s %12.1f MB/s\n", "MPI exchange alone", mpi_alone);
+            printf("%-28s %12.1f MB/s\n", "Write alone", io_alone[1]);
+            printf("%-28s %12.1f MB/s\n", "Read alone", io_alone[0]);
+            print_change("MPI exchange during write", mpi_overlapped[1], mpi_alone);
+            print_change("Write during MPI exchange", io_overlapped[1], io_alone[1]);
+            print_change("MPI exchange during read", mpi_overlapped[0], mpi_alone);
+            print_change("Read during MPI exchange", io_overlapped[0], io_alone[0]);
+        }
+    }
+    MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    buffer_release(&messages);
+    buffer_pool_clear(buffer_pool_shared());
+    MPI_Finalize();
+    return status;
+}
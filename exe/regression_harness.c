@@ -0,0 +1,245 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/bench_harness.h"
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/io_tester.h"
+#include "mpi_test_utils/log.h"
+
+#include <mpi.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MPI_TEST_ITERATIONS 1000
+
+typedef struct {
+    char file_name[256];
+    size_t block_size;
+    size_t n_blocks;
+} io_ctx_t;
+
+static ssize_t elapsed_since(const struct timespec* start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000000000 + (end.tv_nsec - start->tv_nsec);
+}
+
+static ssize_t run_seq_write(void* ctx)
+{
+    io_ctx_t* io = ctx;
+    return test_sequential_write_nompi(io->file_name, io->block_size, io->n_blocks);
+}
+
+static ssize_t run_seq_read(void* ctx)
+{
+    io_ctx_t* io = ctx;
+    return test_sequential_read_nompi(io->file_name, io->block_size, io->n_blocks);
+}
+
+static ssize_t run_rand_read(void* ctx)
+{
+    io_ctx_t* io = ctx;
+    return test_random_read_nompi(io->file_name, io->block_size, io->n_blocks, io->n_blocks);
+}
+
+static ssize_t run_aio_write(void* ctx)
+{
+    io_ctx_t* io = ctx;
+    return test_sequential_write_libaio(io->file_name, io->block_size, io->n_blocks);
+}
+
+static ssize_t run_mpi_barrier(void* ctx)
+{
+    (void)ctx;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < MPI_TEST_ITERATIONS; i++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+    return elapsed_since(&start) / MPI_TEST_ITERATIONS;
+}
+
+static ssize_t run_mpi_allgather(void* ctx)
+{
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    int64_t* all_values = ctx;
+    int64_t value = size;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < MPI_TEST_ITERATIONS; i++) {
+        MPI_Allgather(&value, 1, MPI_INT64_T, all_values, 1, MPI_INT64_T, MPI_COMM_WORLD);
+    }
+    return elapsed_since(&start) / MPI_TEST_ITERATIONS;
+}
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+        "Usage: %s [-k repeats] [-w warmups] [-s MiB per rank] [-d directory] [-b baseline] [-u]\n"
+        "          [-a alpha] [-t min slowdown] [-c confidence]\n"
+        "  -k  Measured repetitions of each test (default 10)\n"
+        "  -w  Discarded warm-up repetitions of each test (default 2)\n"
+        "  -s  I/O size per rank in MiB (default 256)\n"
+        "  -d  Directory for test files (default .)\n"
+        "  -b  Baseline file (default baseline.txt)\n"
+        "  -u  Record a new baseline instead of comparing, also replacing an invalid one\n"
+        "  -a  Significance level of the regression test (default 0.05)\n"
+        "  -t  Minimal relative median slowdown to report (default 0.05)\n"
+        "  -c  Confidence level of median intervals (default 0.95)\n",
+        prog);
+}
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    size_t n_repeats = 10;
+    size_t n_warmup = 2;
+    size_t size_mib = 256;
+    const char* directory = ".";
+    const char* baseline_path = "baseline.txt";
+    int update_baseline = 0;
+    double alpha = 0.05;
+    double min_slowdown = 0.05;
+    double confidence = 0.95;
+    int opt;
+    while ((opt = getopt(argc, argv, "k:w:s:d:b:ua:t:c:h")) != -1) {
+        switch (opt) {
+        case 'k':
+            n_repeats = strtoull(optarg, NULL, 10);
+            break;
+        case 'w':
+            n_warmup = strtoull(optarg, NULL, 10);
+            break;
+        case 's':
+            size_mib = strtoull(optarg, NULL, 10);
+            break;
+        case 'd':
+            directory = optarg;
+            break;
+        case 'b':
+            baseline_path = optarg;
+            break;
+        case 'u':
+            update_baseline = 1;
+            break;
+        case 'a':
+            alpha = strtod(optarg, NULL);
+            break;
+        case 't':
+            min_slowdown = strtod(optarg, NULL);
+            break;
+        case 'c':
+            confidence = strtod(optarg, NULL);
+            break;
+        default:
+            if (rank == 0) {
+                usage(argv[0]);
+            }
+            MPI_Finalize();
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (n_repeats == 0 || size_mib == 0) {
+        if (rank == 0) {
+            usage(argv[0]);
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    env_fingerprint_t env;
+    env_report(directory, MPI_COMM_WORLD, &env, stdout);
+
+    io_ctx_t io = { .block_size = BLOCK_SIZE, .n_blocks = size_mib * M_SIZE / BLOCK_SIZE };
+    snprintf(io.file_name, sizeof(io.file_name), "%s/harness_test.%d", directory, rank);
+    size_t io_bytes = io.block_size * io.n_blocks;
+    int64_t* allgather_buffer = calloc(size, sizeof(int64_t));
+    if (allgather_buffer == NULL) {
+        perror("Failed to allocate allgather buffer");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    bench_case_t cases[] = {
+        { "seq_write", run_seq_write, &io, io_bytes, true },
+        { "seq_read", run_seq_read, &io, io_bytes, true },
+        { "rand_read", run_rand_read, &io, io_bytes, true },
+        { "aio_write", run_aio_write, &io, io_bytes, true },
+        { "mpi_barrier", run_mpi_barrier, NULL, 0, false },
+        { "mpi_allgather", run_mpi_allgather, allgather_buffer, 0, false },
+    };
+    size_t n_cases = sizeof(cases) / sizeof(cases[0]);
+    bench_result_t results[sizeof(cases) / sizeof(cases[0])];
+
+    int status = EXIT_SUCCESS;
+    size_t n_done = 0;
+    for (size_t i = 0; i < n_cases; i++) {
+        if (rank == 0) {
+            log_info("Running %s: %zu warm-up + %zu measured runs on %d ranks", cases[i].name, n_warmup, n_repeats,
+                size);
+        }
+        if (bench_run(&cases[i], n_warmup, n_repeats, confidence, MPI_COMM_WORLD, &results[i]) != 0) {
+            if (rank == 0) {
+                log_error("Benchmark %s failed", cases[i].name);
+            }
+            status = EXIT_FAILURE;
+            break;
+        }
+        n_done++;
+        if (rank == 0) {
+            bench_result_print(&results[i], stdout);
+        }
+    }
+    unlink(io.file_name);
+
+    if (status == EXIT_SUCCESS && rank == 0) {
+        bench_result_t* baseline = NULL;
+        size_t n_baseline = 0;
+        env_fingerprint_t baseline_env;
+        int loaded = update_baseline ? BENCH_BASELINE_MISSING
+                                     : bench_baseline_load(baseline_path, &baseline, &n_baseline, &baseline_env);
+        if (loaded < 0) {
+            // Keep an unreadable baseline for inspection instead of replacing the reference data.
+            log_error("Failed to load baseline %s; fix or remove it, or pass -u to record a new one", baseline_path);
+            status = EXIT_FAILURE;
+        } else if (loaded == BENCH_BASELINE_MISSING) {
+            if (bench_baseline_save(baseline_path, results, n_done, &env) != 0) {
+                status = EXIT_FAILURE;
+            } else {
+                log_info("Baseline written to %s", baseline_path);
+            }
+        } else {
+            if (baseline_env.hostname[0] != '\0') {
+                size_t n_changed = env_diff(&baseline_env, &env, stdout);
+                if (n_changed > 0) {
+                    log_info("Environment differs from %s in %zu field(s), see above", baseline_path, n_changed);
+                }
+            }
+            size_t n_regressed = bench_compare(results, n_done, baseline, n_baseline, alpha, min_slowdown, stdout);
+            if (n_regressed > 0) {
+                log_error("%zu benchmark(s) regressed against %s", n_regressed, baseline_path);
+                status = EXIT_FAILURE;
+            }
+            bench_baseline_free(baseline, n_baseline);
+        }
+    }
+    MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    for (size_t i = 0; i < n_done; i++) {
+        bench_result_free(&results[i]);
+    }
+    free(allgather_buffer);
+    MPI_Finalize();
+    return status;
+}
@@ -0,0 +1,88 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/io_tester.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void print_rate(
+    const char* op, small_file_variant_t variant, size_t file_size, size_t n_files, ssize_t elapsed_ns)
+{
+    double files_per_sec = (double)n_files / (double)elapsed_ns * 1e9;
+    double bandwidth = (double)(file_size * n_files) / (double)elapsed_ns * 1e3; // bytes per ns convert to MB/s
+    printf("%-5s %-8s %4zu KiB: %12.1f files/s %10.3f MB/s\n", op, small_file_variant_name(variant),
+        (size_t)(file_size / K_SIZE), files_per_sec, bandwidth);
+}
+
+int main(int argc, char** argv)
+{
+    const char* dir = ".";
+    size_t n_files = 10000;
+    size_t only_size_kib = 0;
+    bool sync_files = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:n:s:fh")) != -1) {
+        switch (opt) {
+        case 'd':
+            dir = optarg;
+            break;
+        case 'n':
+            n_files = strtoull(optarg, NULL, 10);
+            break;
+        case 's':
+            only_size_kib = strtoull(optarg, NULL, 10);
+            break;
+        case 'f':
+            sync_files = true;
+            break;
+        default:
+            fprintf(stderr,
+                "Usage: %s [-d directory] [-n files] [-s KiB] [-f]\n"
+                "  -d  Directory for test files (default .)\n"
+                "  -n  Number of files (default 10000)\n"
+                "  -s  Only test this file size in KiB (default 4, 16 and 64)\n"
+                "  -f  fsync each file after writing\n",
+                argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    env_fingerprint_t env;
+    env_collect(&env, dir);
+    env_write(&env, "# ", stdout);
+
+    size_t file_sizes[] = { 4 * K_SIZE, 16 * K_SIZE, 64 * K_SIZE };
+    size_t n_sizes = sizeof(file_sizes) / sizeof(file_sizes[0]);
+    if (only_size_kib > 0) {
+        file_sizes[0] = only_size_kib * K_SIZE;
+        n_sizes = 1;
+    }
+
+    int status = EXIT_SUCCESS;
+    for (size_t s = 0; s < n_sizes; s++) {
+        for (small_file_variant_t variant = SMALL_FILE_SYSCALL; variant <= SMALL_FILE_IO_URING; variant++) {
+            if (!small_file_variant_available(variant)) {
+                printf("%-5s %-8s %4zu KiB: skipped, not available\n", "-", small_file_variant_name(variant),
+                    (size_t)(file_sizes[s] / K_SIZE));
+                continue;
+            }
+            ssize_t write_ns = test_small_file_write_nompi(dir, file_sizes[s], n_files, variant, sync_files);
+            ssize_t read_ns = write_ns < 0 ? -1 : test_small_file_read_nompi(dir, file_sizes[s], n_files, variant);
+            if (write_ns < 0 || read_ns < 0) {
+                fprintf(stderr, "Small file test %s failed\n", small_file_variant_name(variant));
+                status = EXIT_FAILURE;
+            } else {
+                print_rate("write", variant, file_sizes[s], n_files, write_ns);
+                print_rate("read", variant, file_sizes[s], n_files, read_ns);
+            }
+            small_file_remove(dir, n_files);
+        }
+    }
+    return status;
+}
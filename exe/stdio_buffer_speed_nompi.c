@@ -0,0 +1,190 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/buffer_pool.h"
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/io_tester.h"
+#include "mpi_test_utils/perf_counters.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_MODES 32
+#define MODE_NAME_LEN 32
+
+typedef enum { TEST_SEQUENTIAL_WRITE, TEST_SEQUENTIAL_READ, TEST_RANDOM_READ, N_TESTS } stdio_test_t;
+
+static const char* test_names[N_TESTS] = { "Sequential write", "Sequential read", "Random read" };
+
+typedef struct {
+    char name[MODE_NAME_LEN];
+    /*!
+     * @brief Raw read/write/pread instead of stdio.
+     */
+    bool syscall;
+    size_t buffer_size;
+    double mbps[N_TESTS];
+    /*!
+     * @brief read or write system calls issued by the test, -1 if unavailable.
+     */
+    int64_t syscalls[N_TESTS];
+} stdio_mode_t;
+
+static void format_size(char* out, size_t size)
+{
+    if (size >= M_SIZE && size % M_SIZE == 0) {
+        snprintf(out, MODE_NAME_LEN, "%zu MiB", (size_t)(size / M_SIZE));
+    } else if (size >= K_SIZE && size % K_SIZE == 0) {
+        snprintf(out, MODE_NAME_LEN, "%zu KiB", (size_t)(size / K_SIZE));
+    } else {
+        snprintf(out, MODE_NAME_LEN, "%zu B", size);
+    }
+}
+
+static void add_mode(stdio_mode_t* modes, size_t* n_modes, const char* name, bool syscall, size_t buffer_size)
+{
+    if (*n_modes == MAX_MODES) {
+        return;
+    }
+    stdio_mode_t* mode = &modes[(*n_modes)++];
+    memset(mode, 0, sizeof(stdio_mode_t));
+    mode->syscall = syscall;
+    mode->buffer_size = buffer_size;
+    if (name != NULL) {
+        snprintf(mode->name, MODE_NAME_LEN, "%s", name);
+    } else {
+        format_size(mode->name, buffer_size);
+    }
+}
+
+static ssize_t run_test(
+    const stdio_mode_t* mode, stdio_test_t test, const char* file_name, size_t block_size, size_t n_blocks)
+{
+    io_tester_set_stdio_buffer(mode->buffer_size);
+    switch (test) {
+    case TEST_SEQUENTIAL_WRITE:
+        return mode->syscall ? test_sequential_write_sync_nompi(file_name, block_size, n_blocks, SYNC_NONE, 1)
+                             : test_sequential_write_nompi(file_name, block_size, n_blocks);
+    case TEST_SEQUENTIAL_READ:
+        return mode->syscall ? test_sequential_read_syscall_nompi(file_name, block_size, n_blocks)
+                             : test_sequential_read_nompi(file_name, block_size, n_blocks);
+    default:
+        return mode->syscall ? test_random_read_syscall_nompi(file_name, block_size, n_blocks, n_blocks)
+                             : test_random_read_nompi(file_name, block_size, n_blocks, n_blocks);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* file_name = "test";
+    size_t total_bytes = G_SIZE;
+    size_t block_size = BLOCK_SIZE;
+    char* size_list = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:s:b:B:h")) != -1) {
+        switch (opt) {
+        case 'f':
+            file_name = optarg;
+            break;
+        case 's':
+            total_bytes = strtoull(optarg, NULL, 10) * M_SIZE;
+            break;
+        case 'b':
+            block_size = strtoull(optarg, NULL, 10);
+            break;
+        case 'B':
+            size_list = optarg;
+            break;
+        default:
+            fprintf(stderr,
+                "Usage: %s [-f file] [-s MiB] [-b bytes] [-B KiB,KiB,...]\n"
+                "  -f  Test file (default test)\n"
+                "  -s  File size in MiB (default 1024)\n"
+                "  -b  Application block size in bytes, i.e. the size of each fwrite/fread (default 4096)\n"
+                "  -B  Comma-separated stream buffer sizes in KiB to try besides the libc default, unbuffered\n"
+                "      and block-sized buffers (default 64,1024,4096,16384)\n",
+                argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (block_size == 0 || total_bytes < block_size) {
+        fprintf(stderr, "Invalid block or file size\n");
+        return EXIT_FAILURE;
+    }
+    size_t n_blocks = total_bytes / block_size;
+    env_fingerprint_t env;
+    env_collect(&env, ".");
+    env_write(&env, "# ", stdout);
+
+    stdio_mode_t modes[MAX_MODES];
+    size_t n_modes = 0;
+    add_mode(modes, &n_modes, "syscall", true, IO_STDIO_BUFFER_DEFAULT);
+    add_mode(modes, &n_modes, "default", false, IO_STDIO_BUFFER_DEFAULT);
+    add_mode(modes, &n_modes, "unbuffered", false, 0);
+    add_mode(modes, &n_modes, "block", false, block_size);
+    if (size_list == NULL) {
+        add_mode(modes, &n_modes, NULL, false, 64 * K_SIZE);
+        add_mode(modes, &n_modes, NULL, false, M_SIZE);
+        add_mode(modes, &n_modes, NULL, false, 4 * M_SIZE);
+        add_mode(modes, &n_modes, NULL, false, 16 * M_SIZE);
+    } else {
+        for (char* size = strtok(size_list, ","); size != NULL; size = strtok(NULL, ",")) {
+            add_mode(modes, &n_modes, NULL, false, strtoull(size, NULL, 10) * K_SIZE);
+        }
+    }
+
+    // Counters supply the number of system calls behind each test.
+    io_tester_set_perf(true);
+    int status = EXIT_SUCCESS;
+    for (size_t m = 0; m < n_modes && status == EXIT_SUCCESS; m++) {
+        stdio_mode_t* mode = &modes[m];
+        for (stdio_test_t test = TEST_SEQUENTIAL_WRITE; test < N_TESTS; test++) {
+            ssize_t elapsed_ns = run_test(mode, test, file_name, block_size, n_blocks);
+            if (elapsed_ns < 0) {
+                fprintf(stderr, "%s with %s buffering failed\n", test_names[test], mode->name);
+                status = EXIT_FAILURE;
+                break;
+            }
+            const perf_sample_t* perf = io_tester_last_perf();
+            mode->mbps[test] = (double)(n_blocks * block_size) / (double)elapsed_ns * 1e3; // bytes per ns to MB/s
+            mode->syscalls[test] = test == TEST_SEQUENTIAL_WRITE ? perf->write_syscalls : perf->read_syscalls;
+        }
+    }
+    io_tester_set_stdio_buffer(IO_STDIO_BUFFER_DEFAULT);
+    unlink(file_name);
+    buffer_pool_clear(buffer_pool_shared());
+    if (status != EXIT_SUCCESS) {
+        return status;
+    }
+
+    printf("%-12s", "Buffer");
+    for (stdio_test_t test = TEST_SEQUENTIAL_WRITE; test < N_TESTS; test++) {
+        printf(" %22s MB/s %9s", test_names[test], "syscalls");
+    }
+    printf("\n");
+    for (size_t m = 0; m < n_modes; m++) {
+        printf("%-12s", modes[m].name);
+        for (stdio_test_t test = TEST_SEQUENTIAL_WRITE; test < N_TESTS; test++) {
+            printf(" %27.1f %9lld", modes[m].mbps[test], (long long)modes[m].syscalls[test]);
+        }
+        printf("\n");
+    }
+
+    // Best stdio buffer per test, relative to raw system calls and to the libc default.
+    for (stdio_test_t test = TEST_SEQUENTIAL_WRITE; test < N_TESTS; test++) {
+        const stdio_mode_t* best = &modes[1];
+        for (size_t m = 1; m < n_modes; m++) {
+            best = modes[m].mbps[test] > best->mbps[test] ? &modes[m] : best;
+        }
+        printf("%s: recommended stream buffer %s, %.1f MB/s, %.2fx raw system calls, %.2fx libc default\n",
+            test_names[test], best->name, best->mbps[test], best->mbps[test] / modes[0].mbps[test],
+            best->mbps[test] / modes[1].mbps[test]);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/io_tester.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+int main(int argc, char** argv)
+{
+    const char* file_name = "test";
+    size_t size_mib = 1024;
+    size_t block_size = BLOCK_SIZE;
+    size_t sync_interval = 256;
+    bool use_stdio = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:s:b:n:Sh")) != -1) {
+        switch (opt) {
+        case 'f':
+            file_name = optarg;
+            break;
+        case 's':
+            size_mib = strtoull(optarg, NULL, 10);
+            break;
+        case 'b':
+            block_size = strtoull(optarg, NULL, 10) * K_SIZE;
+            break;
+        case 'n':
+            sync_interval = strtoull(optarg, NULL, 10);
+            break;
+        case 'S':
+            use_stdio = true;
+            break;
+        default:
+            fprintf(stderr,
+                "Usage: %s [-f file] [-s MiB] [-b block KiB] [-n blocks per sync] [-S]\n"
+                "  -f  Test file (default test)\n"
+                "  -s  Bytes written per policy in MiB (default 1024)\n"
+                "  -b  Block size in KiB (default 4)\n"
+                "  -n  Blocks between fdatasync or sync_file_range windows (default 256)\n"
+                "  -S  Write through stdio, flushing the stream before each sync\n",
+                argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (block_size == 0) {
+        fprintf(stderr, "Block size must be positive\n");
+        return EXIT_FAILURE;
+    }
+    env_fingerprint_t env;
+    env_collect(&env, file_name);
+    env_write(&env, "# ", stdout);
+
+    size_t n_blocks = size_mib * M_SIZE / block_size;
+    size_t total_bytes = n_blocks * block_size;
+    double apparent_bandwidth = 0.0;
+    int status = EXIT_SUCCESS;
+    for (sync_policy_t policy = SYNC_NONE; policy <= SYNC_FILE_RANGE; policy++) {
+        ssize_t elapsed_ns = use_stdio
+            ? test_sequential_write_stdio_sync_nompi(file_name, block_size, n_blocks, policy, sync_interval)
+            : test_sequential_write_sync_nompi(file_name, block_size, n_blocks, policy, sync_interval);
+        unlink(file_name);
+        if (elapsed_ns < 0) {
+            fprintf(stderr, "Sequential write with %s failed\n", sync_policy_name(policy));
+            status = EXIT_FAILURE;
+            continue;
+        }
+        double bandwidth = (double)total_bytes / (double)elapsed_ns * 1e3; // bytes per ns convert to MB/s
+        if (policy == SYNC_NONE) {
+            apparent_bandwidth = bandwidth;
+            printf("Sequential Write Bandwidth (%s, apparent): %.6f MB/s\n", sync_policy_name(policy), bandwidth);
+        } else {
+            printf("Sequential Write Bandwidth (%s, durable): %.6f MB/s (%.1f%% of apparent)\n",
+                sync_policy_name(policy), bandwidth,
+                apparent_bandwidth > 0.0 ? bandwidth / apparent_bandwidth * 100.0 : 0.0);
+        }
+    }
+    return status;
+}
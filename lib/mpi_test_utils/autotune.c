@@ -0,0 +1,271 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/autotune.h"
+#include "mpi_test_utils/constants.h"
+#include "mpi_test_utils/io_engines.h"
+#include "mpi_test_utils/log.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define AUTOTUNE_PATH_LEN 4096
+#define AUTOTUNE_MIN_BLOCK (4 * K_SIZE)
+#define AUTOTUNE_MAX_BLOCK (64 * M_SIZE)
+// The coarse grid is 4 KiB, 64 KiB, 1 MiB and 16 MiB.
+#define AUTOTUNE_COARSE_STEP 16
+#define AUTOTUNE_DEFAULT_QUEUE_DEPTH 8
+#define AUTOTUNE_MAX_QUEUE_DEPTH 256
+#define AUTOTUNE_N_FINALISTS 2
+// Each trial may use this fraction of the budget. A full search takes about as many trials.
+#define AUTOTUNE_PLANNED_TRIALS 40
+#define AUTOTUNE_MAX_TRIALS 256
+
+typedef struct {
+    const autotune_config_t* config;
+    autotune_result_t* result;
+    char path[AUTOTUNE_PATH_LEN];
+    uint64_t start_ns;
+    uint64_t trial_ns;
+    // Wall time of the last trial, including the sync that the time limit does not bound.
+    uint64_t last_cost_ns;
+    double last_mbps;
+    // Every configuration is measured at most once.
+    io_engine_config_t tried[AUTOTUNE_MAX_TRIALS];
+    double tried_mbps[AUTOTUNE_MAX_TRIALS];
+} tuner_t;
+
+typedef enum { PARAM_BLOCK_SIZE, PARAM_THREADS, PARAM_QUEUE_DEPTH } tuner_param_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static bool same_config(const io_engine_config_t* a, const io_engine_config_t* b)
+{
+    return a->engine == b->engine && a->block_size == b->block_size && a->n_threads == b->n_threads
+        && (a->engine != IO_ENGINE_AIO || a->queue_depth == b->queue_depth);
+}
+
+static bool valid_config(const tuner_t* tuner, const io_engine_config_t* candidate)
+{
+    return candidate->block_size >= AUTOTUNE_MIN_BLOCK && candidate->block_size <= AUTOTUNE_MAX_BLOCK
+        && candidate->n_threads >= 1 && candidate->n_threads <= tuner->config->max_threads
+        && candidate->queue_depth >= 1 && candidate->queue_depth <= AUTOTUNE_MAX_QUEUE_DEPTH
+        && candidate->block_size * candidate->n_threads <= tuner->config->file_size;
+}
+
+// Evict the test file from the page cache, so that reads hit storage. It was synced after writing.
+static void drop_cache(const char* path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd != -1) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+// Bytes of a trial. The time limit stops the transfers but not the sync after a write, which flushes whatever
+// the page cache absorbed. Synced writes are therefore capped at what the last trial sustained per share.
+static size_t trial_size(const tuner_t* tuner, const io_engine_config_t* trial)
+{
+    size_t size = tuner->config->file_size;
+    if (tuner->config->read || !tuner->config->sync || tuner->last_mbps <= 0.0) {
+        return size;
+    }
+    size_t stride = trial->block_size * trial->n_threads;
+    double sustained = tuner->last_mbps * 1e-3 * (double)tuner->trial_ns; // MB/s to bytes per share
+    size_t cap = sustained < (double)size ? ((size_t)sustained / stride) * stride : size;
+    return cap < stride ? stride : cap;
+}
+
+// Bandwidth of `candidate` in MB/s, or 0 if it failed.
+// Returns -1 without running anything once the budget cannot fit another trial.
+static double measure(tuner_t* tuner, const io_engine_config_t* candidate)
+{
+    autotune_result_t* result = tuner->result;
+    for (size_t i = 0; i < result->n_trials; i++) {
+        if (same_config(&tuner->tried[i], candidate)) {
+            return tuner->tried_mbps[i];
+        }
+    }
+    // The next trial is expected to cost as much as its share, or as the last one if that overran.
+    uint64_t expected_ns = tuner->last_cost_ns > tuner->trial_ns ? tuner->last_cost_ns : tuner->trial_ns;
+    if (now_ns() - tuner->start_ns + expected_ns > tuner->config->budget_ns
+        || result->n_trials == AUTOTUNE_MAX_TRIALS) {
+        result->budget_exhausted = true;
+        return -1.0;
+    }
+    io_engine_config_t trial = *candidate;
+    trial.sync = tuner->config->sync;
+    trial.time_limit_ns = tuner->trial_ns;
+    uint64_t trial_start = now_ns();
+    if (tuner->config->read) {
+        drop_cache(tuner->path);
+    }
+    uint64_t bytes;
+    size_t size = trial_size(tuner, &trial);
+    ssize_t elapsed_ns = test_engine_nompi(tuner->path, &trial, !tuner->config->read, size, &bytes);
+    double mbps = elapsed_ns > 0 ? (double)bytes / (double)elapsed_ns * 1e3 : 0.0; // bytes per ns to MB/s
+    tuner->last_cost_ns = now_ns() - trial_start;
+    if (mbps > 0.0) {
+        tuner->last_mbps = mbps;
+    }
+
+    tuner->tried[result->n_trials] = trial;
+    tuner->tried_mbps[result->n_trials] = mbps;
+    result->n_trials++;
+    log_info("Trial %zu: %s, %zu-byte blocks, %zu threads, queue depth %zu: %.1f MB/s%s", result->n_trials,
+        io_engine_name(trial.engine), trial.block_size, trial.n_threads, trial.queue_depth, mbps,
+        elapsed_ns < 0 ? " (failed)" : "");
+    if (mbps > result->engine_mbps[trial.engine]) {
+        result->engine_mbps[trial.engine] = mbps;
+    }
+    if (mbps > result->best_mbps) {
+        result->best_mbps = mbps;
+        result->best = trial;
+    }
+    return mbps;
+}
+
+static bool gains(const tuner_t* tuner, double mbps, double reference)
+{
+    return mbps > reference * (1.0 + tuner->config->min_gain);
+}
+
+// One thread, growing block sizes on the coarse grid until they stop paying off.
+static double coarse_search(tuner_t* tuner, io_engine_t engine, io_engine_config_t* best)
+{
+    io_engine_config_t candidate = {
+        .engine = engine, .block_size = AUTOTUNE_MIN_BLOCK, .queue_depth = AUTOTUNE_DEFAULT_QUEUE_DEPTH, .n_threads = 1
+    };
+    *best = candidate;
+    double best_mbps = measure(tuner, &candidate);
+    if (best_mbps <= 0.0) {
+        return 0.0;
+    }
+    for (candidate.block_size *= AUTOTUNE_COARSE_STEP; valid_config(tuner, &candidate);
+         candidate.block_size *= AUTOTUNE_COARSE_STEP) {
+        double mbps = measure(tuner, &candidate);
+        bool gained = gains(tuner, mbps, best_mbps);
+        if (mbps > best_mbps) {
+            best_mbps = mbps;
+            *best = candidate;
+        }
+        if (!gained) {
+            break;
+        }
+    }
+    return best_mbps;
+}
+
+static size_t* param_ref(io_engine_config_t* config, tuner_param_t param)
+{
+    switch (param) {
+    case PARAM_BLOCK_SIZE:
+        return &config->block_size;
+    case PARAM_THREADS:
+        return &config->n_threads;
+    default:
+        return &config->queue_depth;
+    }
+}
+
+// Multiply `param` by `factor` while that gains enough; if the first step up does not, divide instead.
+static void climb(tuner_t* tuner, io_engine_config_t* best, double* best_mbps, tuner_param_t param, size_t factor)
+{
+    for (int up = 1; up >= 0; up--) {
+        bool moved = false;
+        for (;;) {
+            io_engine_config_t candidate = *best;
+            size_t* value = param_ref(&candidate, param);
+            *value = up ? *value * factor : *value / factor;
+            if (!valid_config(tuner, &candidate)) {
+                break;
+            }
+            double mbps = measure(tuner, &candidate);
+            if (!gains(tuner, mbps, *best_mbps)) {
+                break;
+            }
+            *best = candidate;
+            *best_mbps = mbps;
+            moved = true;
+        }
+        if (moved || tuner->result->budget_exhausted) {
+            return;
+        }
+    }
+}
+
+// The coarse grid may have skipped the best block size, and more threads may favour other ones.
+static void fine_search(tuner_t* tuner, io_engine_config_t* best, double* best_mbps)
+{
+    climb(tuner, best, best_mbps, PARAM_BLOCK_SIZE, 4);
+    climb(tuner, best, best_mbps, PARAM_BLOCK_SIZE, 2);
+    climb(tuner, best, best_mbps, PARAM_THREADS, 2);
+    if (best->engine == IO_ENGINE_AIO) {
+        climb(tuner, best, best_mbps, PARAM_QUEUE_DEPTH, 2);
+    }
+    climb(tuner, best, best_mbps, PARAM_BLOCK_SIZE, 2);
+}
+
+// Write the file read by all trials once, outside of any trial.
+static int prepare_read_file(const tuner_t* tuner)
+{
+    io_engine_config_t writer
+        = { .engine = IO_ENGINE_PREAD, .block_size = M_SIZE, .queue_depth = 1, .n_threads = 1, .sync = true };
+    uint64_t bytes;
+    return test_engine_nompi(tuner->path, &writer, true, tuner->config->file_size, &bytes) < 0 ? -1 : 0;
+}
+
+int autotune_nompi(const autotune_config_t* config, autotune_result_t* result)
+{
+    tuner_t tuner;
+    memset(&tuner, 0, sizeof(tuner_t));
+    memset(result, 0, sizeof(autotune_result_t));
+    tuner.config = config;
+    tuner.result = result;
+    tuner.start_ns = now_ns();
+    tuner.trial_ns = config->budget_ns / AUTOTUNE_PLANNED_TRIALS;
+    snprintf(tuner.path, AUTOTUNE_PATH_LEN, "%s/autotune.%ld", config->dir, (long)getpid());
+    if (config->read && prepare_read_file(&tuner) != 0) {
+        unlink(tuner.path);
+        return -1;
+    }
+
+    // Coarse stage over all engines, then refine the best ones.
+    io_engine_config_t finalists[IO_ENGINE_N];
+    double finalist_mbps[IO_ENGINE_N];
+    size_t n_finalists = 0;
+    for (io_engine_t engine = IO_ENGINE_STDIO; engine < IO_ENGINE_N && !result->budget_exhausted; engine++) {
+        io_engine_config_t best;
+        double mbps = coarse_search(&tuner, engine, &best);
+        if (mbps <= 0.0) {
+            continue;
+        }
+        // Insertion sort by bandwidth, best first.
+        size_t pos = n_finalists++;
+        for (; pos > 0 && finalist_mbps[pos - 1] < mbps; pos--) {
+            finalists[pos] = finalists[pos - 1];
+            finalist_mbps[pos] = finalist_mbps[pos - 1];
+        }
+        finalists[pos] = best;
+        finalist_mbps[pos] = mbps;
+    }
+    for (size_t i = 0; i < n_finalists && i < AUTOTUNE_N_FINALISTS && !result->budget_exhausted; i++) {
+        fine_search(&tuner, &finalists[i], &finalist_mbps[i]);
+    }
+
+    unlink(tuner.path);
+    result->elapsed_ns = now_ns() - tuner.start_ns;
+    return result->best_mbps > 0.0 ? 0 : -1;
+}
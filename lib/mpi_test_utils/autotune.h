@@ -0,0 +1,79 @@
+#ifndef MPI_TEST_UTILS_AUTOTUNE_H
+#define MPI_TEST_UTILS_AUTOTUNE_H
+
+#include "mpi_test_utils/io_engines.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @file autotune.h
+ * @brief Search of engine, block size, thread count and queue depth for the highest bandwidth within a time budget.
+ *
+ * A coarse stage tries every engine on a sparse grid of block sizes with one thread. The two best engines are
+ * then refined by hill-climbing block size, threads and queue depth in turn. Each direction is abandoned as soon
+ * as a step gains less than `min_gain`, and the search ends early when the budget cannot fit another trial.
+ */
+
+typedef struct {
+    /*!
+     * @brief Directory in which the test file is created and removed.
+     */
+    const char* dir;
+    uint64_t budget_ns;
+    /*!
+     * @brief Tune reads instead of writes. The file is written once and dropped from the page cache before each trial.
+     */
+    bool read;
+    /*!
+     * @brief Include flushing written data to storage, see #io_engine_config_t.
+     */
+    bool sync;
+    /*!
+     * @brief Bytes per trial. Trials also end when their share of the budget is used up. Synced write trials are
+     * further capped at the bytes the previous trial sustained in one share, since the final sync is not bounded
+     * by the time limit; only the first trial may overrun its share.
+     */
+    size_t file_size;
+    size_t max_threads;
+    /*!
+     * @brief Relative improvement a step must bring for the search to continue in its direction, e.g. 0.05.
+     */
+    double min_gain;
+} autotune_config_t;
+
+typedef struct {
+    /*!
+     * @brief Configuration with the highest bandwidth. Only `engine`, `block_size`, `queue_depth` and `n_threads`
+     * are meaningful.
+     */
+    io_engine_config_t best;
+    double best_mbps;
+    /*!
+     * @brief Highest bandwidth of each engine, 0 if it was unavailable or not tried.
+     */
+    double engine_mbps[IO_ENGINE_N];
+    size_t n_trials;
+    uint64_t elapsed_ns;
+    /*!
+     * @brief The search was cut short by the budget.
+     */
+    bool budget_exhausted;
+} autotune_result_t;
+
+/*!
+ * @brief Run the search. Every trial is logged.
+ * @return 0 if at least one configuration worked, -1 otherwise.
+ */
+int autotune_nompi(const autotune_config_t* config, autotune_result_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_AUTOTUNE_H
@@ -0,0 +1,250 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/bench_harness.h"
+#include "mpi_test_utils/stats.h"
+
+#include <mpi.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BASELINE_HEADER "# mpi_test_utils benchmark baseline v1"
+
+static void summarize(bench_result_t* result, double confidence)
+{
+    result->median_ns = stats_median(result->samples_ns, result->n_samples);
+    if (stats_median_ci(result->samples_ns, result->n_samples, confidence, &result->ci_lo_ns, &result->ci_hi_ns)
+        != 0) {
+        result->ci_lo_ns = result->median_ns;
+        result->ci_hi_ns = result->median_ns;
+    }
+}
+
+int bench_run(const bench_case_t* bc, size_t n_warmup, size_t n_repeats, double confidence, MPI_Comm comm,
+    bench_result_t* out)
+{
+    memset(out, 0, sizeof(bench_result_t));
+    snprintf(out->name, BENCH_NAME_LEN, "%s", bc->name);
+    out->bytes = bc->bytes;
+    out->samples_ns = calloc(n_repeats, sizeof(double));
+    double* local_samples_ns = calloc(n_repeats == 0 ? 1 : n_repeats, sizeof(double));
+    if (out->samples_ns == NULL || local_samples_ns == NULL) {
+        perror("Failed to allocate sample buffer");
+        free(local_samples_ns);
+        bench_result_free(out);
+        return -1;
+    }
+    for (size_t i = 0; i < n_warmup + n_repeats; i++) {
+        MPI_Barrier(comm);
+        int64_t elapsed_ns = (int64_t)bc->fn(bc->ctx);
+        int64_t max_elapsed_ns, min_elapsed_ns;
+        MPI_Allreduce(&elapsed_ns, &max_elapsed_ns, 1, MPI_INT64_T, MPI_MAX, comm);
+        MPI_Allreduce(&elapsed_ns, &min_elapsed_ns, 1, MPI_INT64_T, MPI_MIN, comm);
+        if (min_elapsed_ns < 0) {
+            free(local_samples_ns);
+            bench_result_free(out);
+            return -1;
+        }
+        if (i >= n_warmup) {
+            local_samples_ns[out->n_samples] = (double)elapsed_ns;
+            out->samples_ns[out->n_samples++] = (double)max_elapsed_ns;
+        }
+    }
+    summarize(out, confidence);
+    if (bc->detect_stragglers) {
+        double local_median_ns = stats_median(local_samples_ns, out->n_samples);
+        if (straggler_detect(local_median_ns, false, STRAGGLER_DEFAULT_Z, comm, &out->stragglers) != 0) {
+            fprintf(stderr, "Straggler detection of %s failed\n", bc->name);
+            free(local_samples_ns);
+            bench_result_free(out);
+            return -1;
+        }
+    }
+    free(local_samples_ns);
+    return 0;
+}
+
+void bench_result_free(bench_result_t* result)
+{
+    free(result->samples_ns);
+    result->samples_ns = NULL;
+    result->n_samples = 0;
+    straggler_report_free(&result->stragglers);
+}
+
+void bench_result_print(const bench_result_t* result, FILE* out)
+{
+    if (result->bytes == 0) {
+        fprintf(out, "%-24s median %.3f us [%.3f, %.3f] (n=%zu)\n", result->name, result->median_ns / 1e3,
+            result->ci_lo_ns / 1e3, result->ci_hi_ns / 1e3, result->n_samples);
+    } else {
+        // Higher time means lower bandwidth, so bounds are swapped.
+        double bytes = (double)result->bytes;
+        fprintf(out, "%-24s median %.3f MB/s [%.3f, %.3f] (n=%zu)\n", result->name,
+            bytes / result->median_ns * 1e3, bytes / result->ci_hi_ns * 1e3, bytes / result->ci_lo_ns * 1e3,
+            result->n_samples);
+    }
+    straggler_report_print(&result->stragglers, result->name, out);
+}
+
+int bench_baseline_save(
+    const char* path, const bench_result_t* results, size_t n_results, const env_fingerprint_t* env)
+{
+    FILE* file = fopen(path, "we");
+    if (file == NULL) {
+        perror("Failed to open baseline file for writing");
+        return -1;
+    }
+    fprintf(file, "%s\n", BASELINE_HEADER);
+    if (env != NULL) {
+        env_write(env, "# ", file);
+    }
+    for (size_t i = 0; i < n_results; i++) {
+        fprintf(file, "%s %zu %zu", results[i].name, results[i].bytes, results[i].n_samples);
+        for (size_t j = 0; j < results[i].n_samples; j++) {
+            fprintf(file, " %.0f", results[i].samples_ns[j]);
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+    return 0;
+}
+
+// Skip comment lines before the next benchmark, picking up fingerprint fields on the way.
+static void read_comments(FILE* file, env_fingerprint_t* env)
+{
+    char line[ENV_FIELD_LEN + 64];
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (isspace(c)) {
+            continue;
+        }
+        if (c != '#') {
+            ungetc(c, file);
+            return;
+        }
+        if (fgets(line, sizeof(line), file) == NULL) {
+            return;
+        }
+        if (env != NULL) {
+            env_parse_line(env, line[0] == ' ' ? line + 1 : line);
+        }
+    }
+}
+
+int bench_baseline_load(const char* path, bench_result_t** results, size_t* n_results, env_fingerprint_t* env)
+{
+    FILE* file = fopen(path, "re");
+    if (file == NULL) {
+        if (errno == ENOENT) {
+            return BENCH_BASELINE_MISSING;
+        }
+        perror("Failed to open baseline");
+        return -1;
+    }
+    char header[128] = { 0 };
+    if (fgets(header, sizeof(header), file) == NULL || strncmp(header, BASELINE_HEADER, strlen(BASELINE_HEADER)) != 0) {
+        fprintf(stderr, "%s: not a benchmark baseline file\n", path);
+        fclose(file);
+        return -1;
+    }
+    size_t capacity = 8;
+    size_t count = 0;
+    bench_result_t* loaded = calloc(capacity, sizeof(bench_result_t));
+    if (loaded == NULL) {
+        perror("Failed to allocate baseline");
+        fclose(file);
+        return -1;
+    }
+    if (env != NULL) {
+        memset(env, 0, sizeof(env_fingerprint_t));
+    }
+    char name[BENCH_NAME_LEN];
+    size_t bytes, n_samples;
+    read_comments(file, env);
+    while (fscanf(file, "%63s %zu %zu", name, &bytes, &n_samples) == 3) {
+        if (count == capacity) {
+            capacity *= 2;
+            bench_result_t* grown = realloc(loaded, capacity * sizeof(bench_result_t));
+            if (grown == NULL) {
+                perror("Failed to allocate baseline");
+                goto fail;
+            }
+            loaded = grown;
+        }
+        bench_result_t* result = &loaded[count];
+        memset(result, 0, sizeof(bench_result_t));
+        snprintf(result->name, BENCH_NAME_LEN, "%s", name);
+        result->bytes = bytes;
+        result->samples_ns = calloc(n_samples == 0 ? 1 : n_samples, sizeof(double));
+        if (result->samples_ns == NULL) {
+            perror("Failed to allocate baseline");
+            goto fail;
+        }
+        count++;
+        for (size_t j = 0; j < n_samples; j++) {
+            if (fscanf(file, "%lf", &result->samples_ns[j]) != 1) {
+                fprintf(stderr, "%s: truncated samples for %s\n", path, name);
+                goto fail;
+            }
+            result->n_samples++;
+        }
+        summarize(result, 0.95);
+        read_comments(file, env);
+    }
+    // Anything but trailing comments and whitespace means a line that did not parse.
+    read_comments(file, env);
+    if (ferror(file) || !feof(file)) {
+        fprintf(stderr, "%s: invalid line after %zu benchmarks\n", path, count);
+        goto fail;
+    }
+    fclose(file);
+    *results = loaded;
+    *n_results = count;
+    return 0;
+fail:
+    bench_baseline_free(loaded, count);
+    fclose(file);
+    return -1;
+}
+
+void bench_baseline_free(bench_result_t* results, size_t n_results)
+{
+    for (size_t i = 0; i < n_results; i++) {
+        bench_result_free(&results[i]);
+    }
+    free(results);
+}
+
+size_t bench_compare(const bench_result_t* current, size_t n_current, const bench_result_t* baseline,
+    size_t n_baseline, double alpha, double min_slowdown, FILE* out)
+{
+    size_t n_regressed = 0;
+    for (size_t i = 0; i < n_current; i++) {
+        const bench_result_t* base = NULL;
+        for (size_t j = 0; j < n_baseline; j++) {
+            if (strcmp(current[i].name, baseline[j].name) == 0) {
+                base = &baseline[j];
+                break;
+            }
+        }
+        if (base == NULL || base->n_samples == 0) {
+            fprintf(out, "%-24s no baseline\n", current[i].name);
+            continue;
+        }
+        double slowdown = current[i].median_ns / base->median_ns - 1.0;
+        double p_value = stats_mann_whitney_greater(
+            current[i].samples_ns, current[i].n_samples, base->samples_ns, base->n_samples);
+        int regressed = p_value < alpha && slowdown > min_slowdown;
+        fprintf(out, "%-24s %+.2f%% (p=%.4f) %s\n", current[i].name, slowdown * 100.0, p_value,
+            regressed ? "REGRESSION" : "ok");
+        n_regressed += regressed;
+    }
+    return n_regressed;
+}
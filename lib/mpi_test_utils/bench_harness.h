@@ -0,0 +1,117 @@
+#ifndef MPI_TEST_UTILS_BENCH_HARNESS_H
+#define MPI_TEST_UTILS_BENCH_HARNESS_H
+
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/straggler.h"
+
+#include <mpi.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_NAME_LEN 64
+
+/*!
+ * @brief Returned by #bench_baseline_load when there is no baseline file yet.
+ */
+#define BENCH_BASELINE_MISSING 1
+
+/*!
+ * @brief A single benchmark run. Returns elapsed time in nanoseconds, or a negative value on failure.
+ */
+typedef ssize_t (*bench_fn_t)(void* ctx);
+
+typedef struct {
+    const char* name;
+    bench_fn_t fn;
+    void* ctx;
+    /*!
+     * @brief Bytes moved by each rank per run, used to report bandwidth. Zero for latency-type tests.
+     */
+    size_t bytes;
+    /*!
+     * @brief The elapsed time of a rank depends only on its own work, so slow ranks are reported as stragglers.
+     * Leave false for collectives, where the ranks that wait absorb the delay of a late one.
+     */
+    bool detect_stragglers;
+} bench_case_t;
+
+typedef struct {
+    char name[BENCH_NAME_LEN];
+    size_t bytes;
+    size_t n_samples;
+    /*!
+     * @brief Elapsed time of each repetition in nanoseconds, taken from the slowest rank.
+     */
+    double* samples_ns;
+    double median_ns;
+    double ci_lo_ns;
+    double ci_hi_ns;
+    /*!
+     * @brief Ranks whose median elapsed time is an outlier, if `detect_stragglers` was set.
+     */
+    straggler_report_t stragglers;
+} bench_result_t;
+
+/*!
+ * @brief Run a benchmark case `n_warmup + n_repeats` times on all ranks of `comm`, discarding warm-up runs.
+ *
+ * Ranks are synchronized with a barrier before each run and the slowest rank defines the sample.
+ * Samples and summary statistics are valid on all ranks.
+ *
+ * @return 0 on success, -1 if any rank failed or straggler detection failed, on all ranks.
+ */
+int bench_run(const bench_case_t* bc, size_t n_warmup, size_t n_repeats, double confidence, MPI_Comm comm,
+    bench_result_t* out);
+
+void bench_result_free(bench_result_t* result);
+
+void bench_result_print(const bench_result_t* result, FILE* out);
+
+/*!
+ * @brief Save results as a plain-text baseline file, one benchmark per line.
+ *
+ * `env`, if not NULL, is recorded as comment lines so that a later comparison can tell what changed.
+ */
+int bench_baseline_save(
+    const char* path, const bench_result_t* results, size_t n_results, const env_fingerprint_t* env);
+
+/*!
+ * @brief Load a baseline file written by #bench_baseline_save.
+ *
+ * On success `*results` is allocated and must be released with #bench_baseline_free.
+ * `env`, if not NULL, receives the recorded fingerprint; its fields are empty if the baseline has none.
+ *
+ * @return 0 on success, #BENCH_BASELINE_MISSING if `path` does not exist, -1 if it cannot be read or is not a valid
+ * baseline.
+ */
+int bench_baseline_load(const char* path, bench_result_t** results, size_t* n_results, env_fingerprint_t* env);
+
+void bench_baseline_free(bench_result_t* results, size_t n_results);
+
+/*!
+ * @brief Compare current results against a baseline.
+ *
+ * A benchmark is flagged as regressed if its samples are significantly slower than the baseline
+ * under a one-sided Mann-Whitney U test at level `alpha`,
+ * and its median slowed down by more than `min_slowdown` (e.g., 0.05 for 5 %).
+ *
+ * @return Number of regressed benchmarks.
+ */
+size_t bench_compare(const bench_result_t* current, size_t n_current, const bench_result_t* baseline,
+    size_t n_baseline, double alpha, double min_slowdown, FILE* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_BENCH_HARNESS_H
@@ -0,0 +1,137 @@
+// MAP_HUGETLB and MADV_HUGEPAGE are Linux-specific
+#define _GNU_SOURCE // NOLINT
+
+#include "mpi_test_utils/buffer_pool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static buffer_pool_t SHARED_POOL = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+// Default huge page size from /proc/meminfo, or 0 if unknown.
+static size_t huge_page_size(void)
+{
+    FILE* file = fopen("/proc/meminfo", "re");
+    if (file == NULL) {
+        return 0;
+    }
+    char line[256];
+    size_t size_kib = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "Hugepagesize: %zu kB", &size_kib) == 1) {
+            break;
+        }
+    }
+    fclose(file);
+    return size_kib * 1024;
+}
+
+static size_t round_up(size_t size, size_t alignment) { return (size + alignment - 1) / alignment * alignment; }
+
+int buffer_alloc(buffer_t* buffer, size_t size, int flags)
+{
+    memset(buffer, 0, sizeof(buffer_t));
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    void* data = MAP_FAILED;
+    size_t mapped = 0;
+    if (flags & BUFFER_HUGE_PAGES) {
+        size_t huge_size = huge_page_size();
+        if (huge_size > 0) {
+            mapped = round_up(size == 0 ? 1 : size, huge_size);
+            // Fails with ENOMEM unless enough huge pages are reserved in vm.nr_hugepages.
+            data = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            buffer->huge_pages = data != MAP_FAILED;
+        }
+    }
+    if (data == MAP_FAILED) {
+        mapped = round_up(size == 0 ? 1 : size, page_size);
+        data = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) {
+            perror("Failed to map buffer");
+            return -1;
+        }
+        // Must precede the first touch for the kernel to back the range with transparent huge pages.
+        if ((flags & BUFFER_HUGE_PAGES) && madvise(data, mapped, MADV_HUGEPAGE) != 0) {
+            perror("Failed to request transparent huge pages");
+        }
+    }
+    // Fault in every page now rather than on first use inside a timed region.
+    for (size_t offset = 0; offset < mapped; offset += page_size) {
+        ((volatile char*)data)[offset] = 0;
+    }
+    if (flags & BUFFER_LOCKED) {
+        if (mlock(data, mapped) == 0) {
+            buffer->locked = true;
+        } else {
+            perror("Failed to lock buffer");
+        }
+    }
+    buffer->data = data;
+    buffer->size = size;
+    buffer->mapped = mapped;
+    return 0;
+}
+
+void buffer_release(buffer_t* buffer)
+{
+    if (buffer->data != NULL) {
+        munmap(buffer->data, buffer->mapped);
+    }
+    memset(buffer, 0, sizeof(buffer_t));
+}
+
+buffer_pool_t* buffer_pool_shared(void) { return &SHARED_POOL; }
+
+void buffer_pool_set_flags(buffer_pool_t* pool, int flags)
+{
+    buffer_pool_clear(pool);
+    pthread_mutex_lock(&pool->mutex);
+    pool->flags = flags;
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void* buffer_pool_get(buffer_pool_t* pool, size_t slot, size_t size)
+{
+    pthread_mutex_lock(&pool->mutex);
+    if (slot >= pool->n_slots) {
+        size_t n_slots = slot + 1 > pool->n_slots * 2 ? slot + 1 : pool->n_slots * 2;
+        buffer_t* slots = realloc(pool->slots, n_slots * sizeof(buffer_t));
+        if (slots == NULL) {
+            perror("Failed to grow buffer pool");
+            pthread_mutex_unlock(&pool->mutex);
+            return NULL;
+        }
+        memset(slots + pool->n_slots, 0, (n_slots - pool->n_slots) * sizeof(buffer_t));
+        pool->slots = slots;
+        pool->n_slots = n_slots;
+    }
+    buffer_t* buffer = &pool->slots[slot];
+    if (buffer->data == NULL || buffer->mapped < size) {
+        buffer_release(buffer);
+        if (buffer_alloc(buffer, size, pool->flags) != 0) {
+            pthread_mutex_unlock(&pool->mutex);
+            return NULL;
+        }
+    }
+    void* data = buffer->data;
+    pthread_mutex_unlock(&pool->mutex);
+    return data;
+}
+
+void buffer_pool_clear(buffer_pool_t* pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    for (size_t i = 0; i < pool->n_slots; i++) {
+        buffer_release(&pool->slots[i]);
+    }
+    free(pool->slots);
+    pool->slots = NULL;
+    pool->n_slots = 0;
+    pthread_mutex_unlock(&pool->mutex);
+}
@@ -0,0 +1,99 @@
+#ifndef MPI_TEST_UTILS_BUFFER_POOL_H
+#define MPI_TEST_UTILS_BUFFER_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @file buffer_pool.h
+ * @brief Page-aligned, prefaulted I/O buffers that are reused across tests,
+ * so that page faults and TLB misses of fresh allocations stay out of timed regions.
+ */
+
+typedef enum {
+    /*!
+     * @brief Back the buffer with explicit huge pages (MAP_HUGETLB),
+     * falling back to transparent huge pages if none are reserved.
+     */
+    BUFFER_HUGE_PAGES = 1 << 0,
+    /*!
+     * @brief mlock the buffer. A failure, e.g. due to RLIMIT_MEMLOCK, is reported but not fatal.
+     */
+    BUFFER_LOCKED = 1 << 1
+} buffer_flags_t;
+
+typedef struct {
+    void* data;
+    /*!
+     * @brief Usable size, as requested.
+     */
+    size_t size;
+    /*!
+     * @brief Length of the mapping, rounded up to the (huge) page size.
+     */
+    size_t mapped;
+    /*!
+     * @brief Whether the mapping uses explicit huge pages.
+     */
+    bool huge_pages;
+    bool locked;
+} buffer_t;
+
+/*!
+ * @brief Map a zeroed buffer of `size` bytes and fault in all of its pages.
+ * @param flags Bitwise OR of #buffer_flags_t.
+ * @return 0 on success, -1 on failure.
+ */
+int buffer_alloc(buffer_t* buffer, size_t size, int flags);
+void buffer_release(buffer_t* buffer);
+
+/*!
+ * @brief Buffers indexed by slot. A slot keeps its mapping until a larger size is requested or the pool is cleared.
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    int flags;
+    size_t n_slots;
+    buffer_t* slots;
+} buffer_pool_t;
+
+/*!
+ * @brief Slots of the pool returned by #buffer_pool_shared. `BUFFER_SLOT_STDIO` holds the stream buffer set with
+ * #io_tester_set_stdio_buffer. Threaded tests use `BUFFER_SLOT_THREADS + <thread index>`, one slot per concurrently
+ * running thread.
+ */
+enum { BUFFER_SLOT_IO = 0, BUFFER_SLOT_AUX = 1, BUFFER_SLOT_STDIO = 2, BUFFER_SLOT_THREADS = 3 };
+
+/*!
+ * @brief Pool shared by all tests of the library.
+ */
+buffer_pool_t* buffer_pool_shared(void);
+
+/*!
+ * @brief Set #buffer_flags_t of future mappings. Buffers already in the pool are released.
+ */
+void buffer_pool_set_flags(buffer_pool_t* pool, int flags);
+
+/*!
+ * @brief Buffer of at least `size` bytes in `slot`, mapped on first use and reused afterwards.
+ *
+ * Call this before the timed region. The content of a reused buffer is left as is.
+ * @return Pointer to the buffer, or NULL on failure.
+ */
+void* buffer_pool_get(buffer_pool_t* pool, size_t slot, size_t size);
+
+/*!
+ * @brief Unmap every buffer of the pool.
+ */
+void buffer_pool_clear(buffer_pool_t* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_BUFFER_POOL_H
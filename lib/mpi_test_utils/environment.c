@@ -0,0 +1,475 @@
+// getxattr, statfs and realpath need Linux and XSI extensions
+#define _GNU_SOURCE // NOLINT
+
+#include "mpi_test_utils/environment.h"
+#include "mpi_test_utils/topology.h"
+
+#include <mpi.h>
+
+#include <limits.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/statfs.h>
+#include <sys/utsname.h>
+#include <sys/xattr.h>
+#include <unistd.h>
+
+#define MAX_CORES 4096
+
+typedef struct {
+    const char* name;
+    size_t offset;
+} env_field_t;
+
+#define ENV_FIELD(field) { #field, offsetof(env_fingerprint_t, field) }
+
+// The hostname must stay first: it is the only field that is not compared.
+static const env_field_t FIELDS[] = {
+    ENV_FIELD(hostname),
+    ENV_FIELD(cpu_model),
+    ENV_FIELD(cpus),
+    ENV_FIELD(numa_layout),
+    ENV_FIELD(memory),
+    ENV_FIELD(kernel),
+    ENV_FIELD(fs_type),
+    ENV_FIELD(fs_source),
+    ENV_FIELD(fs_mount_point),
+    ENV_FIELD(fs_mount_options),
+    ENV_FIELD(fs_super_options),
+    ENV_FIELD(stripe),
+    ENV_FIELD(mpi_library),
+};
+
+#define N_FIELDS (sizeof(FIELDS) / sizeof(FIELDS[0]))
+
+static char* field(env_fingerprint_t* env, size_t i) { return (char*)env + FIELDS[i].offset; }
+
+static const char* const_field(const env_fingerprint_t* env, size_t i)
+{
+    return (const char*)env + FIELDS[i].offset;
+}
+
+static void set_field(char* dst, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vsnprintf(dst, ENV_FIELD_LEN, format, args);
+    va_end(args);
+}
+
+static void strip_newline(char* str) { str[strcspn(str, "\n")] = '\0'; }
+
+static void collect_cpu(env_fingerprint_t* env)
+{
+    long n_online = sysconf(_SC_NPROCESSORS_ONLN);
+    FILE* file = fopen("/proc/cpuinfo", "re");
+    if (file == NULL) {
+        set_field(env->cpus, "%ld", n_online);
+        return;
+    }
+    // Physical cores are distinct (physical id, core id) pairs.
+    static uint64_t cores[MAX_CORES];
+    size_t n_cores = 0;
+    long physical_id = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char* value = strchr(line, ':');
+        if (value == NULL) {
+            continue;
+        }
+        value += value[1] == ' ' ? 2 : 1;
+        strip_newline(value);
+        if (strncmp(line, "model name", 10) == 0 && strcmp(env->cpu_model, "unknown") == 0) {
+            set_field(env->cpu_model, "%s", value);
+        } else if (strncmp(line, "physical id", 11) == 0) {
+            physical_id = strtol(value, NULL, 10);
+        } else if (strncmp(line, "core id", 7) == 0 && n_cores < MAX_CORES) {
+            uint64_t key = (uint64_t)physical_id << 32 | (uint64_t)strtol(value, NULL, 10);
+            size_t i = 0;
+            while (i < n_cores && cores[i] != key) {
+                i++;
+            }
+            if (i == n_cores) {
+                cores[n_cores++] = key;
+            }
+        }
+    }
+    fclose(file);
+    if (n_cores > 0) {
+        set_field(env->cpus, "%ld (%zu cores)", n_online, n_cores);
+    } else {
+        set_field(env->cpus, "%ld", n_online);
+    }
+}
+
+static void collect_numa(env_fingerprint_t* env)
+{
+    char path[128];
+    char cpulist[ENV_FIELD_LEN];
+    size_t len = 0;
+    int nodes[TOPOLOGY_MAX_NODES];
+    int n_nodes = topology_online_nodes(nodes, TOPOLOGY_MAX_NODES);
+    for (int i = 0; i < n_nodes; i++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodes[i]);
+        FILE* file = fopen(path, "re");
+        if (file == NULL) {
+            break;
+        }
+        if (fgets(cpulist, sizeof(cpulist), file) == NULL) {
+            cpulist[0] = '\0';
+        }
+        fclose(file);
+        strip_newline(cpulist);
+        int ret = snprintf(env->numa_layout + len, ENV_FIELD_LEN - len, "%s%s", i == 0 ? "" : " | ", cpulist);
+        if (ret < 0 || (size_t)ret >= ENV_FIELD_LEN - len) {
+            break;
+        }
+        len += (size_t)ret;
+    }
+    if (len == 0) {
+        set_field(env->numa_layout, "none");
+    }
+}
+
+static void collect_memory(env_fingerprint_t* env)
+{
+    FILE* file = fopen("/proc/meminfo", "re");
+    if (file == NULL) {
+        return;
+    }
+    char line[256];
+    unsigned long long total_kib;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "MemTotal: %llu kB", &total_kib) == 1) {
+            set_field(env->memory, "%.1f GiB", (double)total_kib / (1024.0 * 1024.0));
+            break;
+        }
+    }
+    fclose(file);
+}
+
+static const char* fs_magic_name(long magic)
+{
+    switch (magic) {
+    case 0xEF53:
+        return "ext2/3/4";
+    case 0x58465342:
+        return "xfs";
+    case 0x9123683E:
+        return "btrfs";
+    case 0x01021994:
+        return "tmpfs";
+    case 0x6969:
+        return "nfs";
+    case 0x0BD00BD0:
+        return "lustre";
+    case 0x47504653:
+        return "gpfs";
+    case 0x19830326:
+        return "beegfs";
+    case 0x794C7630:
+        return "overlay";
+    default:
+        return NULL;
+    }
+}
+
+// mountinfo escapes space, tab, newline and backslash in paths as three octal digits, e.g. "\040".
+static void unescape_mountinfo(char* str)
+{
+    char* out = str;
+    for (const char* in = str; *in != '\0'; in++) {
+        if (in[0] == '\\' && in[1] >= '0' && in[1] <= '3' && in[2] >= '0' && in[2] <= '7' && in[3] >= '0'
+            && in[3] <= '7') {
+            *out++ = (char)((in[1] - '0') * 64 + (in[2] - '0') * 8 + (in[3] - '0'));
+            in += 3;
+        } else {
+            *out++ = *in;
+        }
+    }
+    *out = '\0';
+}
+
+// The mount holding `path` is the one with the longest mount point that is a path prefix of it.
+static void collect_mount(env_fingerprint_t* env, const char* path)
+{
+    char resolved[PATH_MAX];
+    if (realpath(path, resolved) == NULL) {
+        return;
+    }
+    FILE* file = fopen("/proc/self/mountinfo", "re");
+    if (file == NULL) {
+        return;
+    }
+    // Format: id parent major:minor root mount_point mount_options [optional fields] - type source super_options
+    char line[4096];
+    size_t best_len = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        strip_newline(line);
+        char mount_point[PATH_MAX];
+        char mount_options[ENV_FIELD_LEN];
+        if (sscanf(line, "%*s %*s %*s %*s %4095s %255s", mount_point, mount_options) != 2) {
+            continue;
+        }
+        unescape_mountinfo(mount_point);
+        size_t len = strlen(mount_point);
+        bool is_prefix = strncmp(resolved, mount_point, len) == 0
+            && (len == 1 || resolved[len] == '/' || resolved[len] == '\0');
+        const char* separator = strstr(line, " - ");
+        if (!is_prefix || len < best_len || separator == NULL) {
+            continue;
+        }
+        char type[ENV_FIELD_LEN];
+        char source[ENV_FIELD_LEN];
+        char super_options[ENV_FIELD_LEN];
+        if (sscanf(separator, " - %255s %255s %255s", type, source, super_options) != 3) {
+            continue;
+        }
+        unescape_mountinfo(source);
+        best_len = len;
+        set_field(env->fs_type, "%s", type);
+        set_field(env->fs_source, "%s", source);
+        set_field(env->fs_mount_point, "%s", mount_point);
+        set_field(env->fs_mount_options, "%s", mount_options);
+        set_field(env->fs_super_options, "%s", super_options);
+    }
+    fclose(file);
+}
+
+static void collect_fs(env_fingerprint_t* env, const char* path)
+{
+    collect_mount(env, path);
+    struct statfs st;
+    if (strcmp(env->fs_type, "unknown") == 0 && statfs(path, &st) == 0) {
+        const char* name = fs_magic_name((long)st.f_type);
+        if (name != NULL) {
+            set_field(env->fs_type, "%s", name);
+        } else {
+            set_field(env->fs_type, "0x%lx", (unsigned long)st.f_type);
+        }
+    }
+}
+
+// Reads the lov_user_md returned for the "lustre.lov" attribute. Only the plain (v1/v3) layout is decoded;
+// composite layouts are reported as such.
+static void collect_stripe(env_fingerprint_t* env, const char* path)
+{
+    if (strcmp(env->fs_type, "lustre") != 0) {
+        set_field(env->stripe, "n/a");
+        return;
+    }
+    unsigned char lov[4096];
+    ssize_t len = getxattr(path, "lustre.lov", lov, sizeof(lov));
+    if (len < 0) {
+        set_field(env->stripe, "default");
+        return;
+    }
+    uint32_t magic;
+    memcpy(&magic, lov, sizeof(magic));
+    if ((magic == 0x0BD10BD0 || magic == 0x0BD30BD0) && len >= 32) {
+        // lmm_magic, lmm_pattern, lmm_oi (16 bytes), then lmm_stripe_size, lmm_stripe_count, lmm_stripe_offset.
+        uint32_t stripe_size;
+        uint16_t stripe_count;
+        uint16_t stripe_offset;
+        memcpy(&stripe_size, lov + 24, sizeof(stripe_size));
+        memcpy(&stripe_count, lov + 28, sizeof(stripe_count));
+        memcpy(&stripe_offset, lov + 30, sizeof(stripe_offset));
+        set_field(env->stripe, "count=%d size=%u offset=%d", stripe_count == 0xFFFF ? -1 : (int)stripe_count,
+            stripe_size, stripe_offset == 0xFFFF ? -1 : (int)stripe_offset);
+    } else if (magic == 0x0BD60BD0) {
+        set_field(env->stripe, "composite layout");
+    } else {
+        set_field(env->stripe, "unknown layout 0x%x", magic);
+    }
+}
+
+static void collect_mpi(env_fingerprint_t* env)
+{
+    char version[MPI_MAX_LIBRARY_VERSION_STRING];
+    int len;
+    // One of the few MPI calls allowed before MPI_Init.
+    if (MPI_Get_library_version(version, &len) != MPI_SUCCESS) {
+        return;
+    }
+    strip_newline(version);
+    len = (int)strlen(version);
+    while (len > 0 && (version[len - 1] == ' ' || version[len - 1] == ',')) {
+        version[--len] = '\0';
+    }
+    set_field(env->mpi_library, "%s", version);
+}
+
+void env_collect(env_fingerprint_t* env, const char* path)
+{
+    memset(env, 0, sizeof(env_fingerprint_t));
+    for (size_t i = 0; i < N_FIELDS; i++) {
+        set_field(field(env, i), "unknown");
+    }
+    struct utsname uts;
+    if (uname(&uts) == 0) {
+        set_field(env->hostname, "%s", uts.nodename);
+        set_field(env->kernel, "%s %s %s", uts.sysname, uts.release, uts.machine);
+    }
+    collect_cpu(env);
+    collect_numa(env);
+    collect_memory(env);
+    // A test file may not exist yet; its directory is on the same filesystem.
+    char existing[PATH_MAX];
+    snprintf(existing, sizeof(existing), "%s", path);
+    if (access(existing, F_OK) != 0) {
+        char* slash = strrchr(existing, '/');
+        if (slash == NULL) {
+            snprintf(existing, sizeof(existing), ".");
+        } else {
+            slash[slash == existing ? 1 : 0] = '\0';
+        }
+    }
+    collect_fs(env, existing);
+    collect_stripe(env, existing);
+    collect_mpi(env);
+}
+
+static void write_fields(const env_fingerprint_t* env, size_t first, const char* prefix, FILE* out)
+{
+    for (size_t i = first; i < N_FIELDS; i++) {
+        fprintf(out, "%s%s: %s\n", prefix, FIELDS[i].name, const_field(env, i));
+    }
+}
+
+void env_write(const env_fingerprint_t* env, const char* prefix, FILE* out) { write_fields(env, 0, prefix, out); }
+
+int env_parse_line(env_fingerprint_t* env, const char* line)
+{
+    for (size_t i = 0; i < N_FIELDS; i++) {
+        size_t len = strlen(FIELDS[i].name);
+        if (strncmp(line, FIELDS[i].name, len) == 0 && strncmp(line + len, ": ", 2) == 0) {
+            set_field(field(env, i), "%s", line + len + 2);
+            strip_newline(field(env, i));
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static bool env_equal(const env_fingerprint_t* a, const env_fingerprint_t* b)
+{
+    for (size_t i = 1; i < N_FIELDS; i++) {
+        if (strcmp(const_field(a, i), const_field(b, i)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t env_diff(const env_fingerprint_t* a, const env_fingerprint_t* b, FILE* out)
+{
+    size_t n_diff = 0;
+    for (size_t i = 1; i < N_FIELDS; i++) {
+        if (strcmp(const_field(a, i), const_field(b, i)) != 0) {
+            fprintf(out, "%s: %s -> %s\n", FIELDS[i].name, const_field(a, i), const_field(b, i));
+            n_diff++;
+        }
+    }
+    return n_diff;
+}
+
+void env_report(const char* path, MPI_Comm comm, env_fingerprint_t* local, FILE* out)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm host_comm;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &host_comm);
+    int host_rank, host_size;
+    MPI_Comm_rank(host_comm, &host_rank);
+    MPI_Comm_size(host_comm, &host_size);
+    MPI_Comm_free(&host_comm);
+    // Ordering by rank makes rank 0 of `comm` rank 0 of the leaders.
+    MPI_Comm leader_comm;
+    MPI_Comm_split(comm, host_rank == 0 ? 0 : MPI_UNDEFINED, rank, &leader_comm);
+    if (leader_comm == MPI_COMM_NULL) {
+        // Not part of the report, but callers may still rely on their own fingerprint.
+        if (local != NULL) {
+            env_collect(local, path);
+        }
+        return;
+    }
+
+    env_fingerprint_t env;
+    env_collect(&env, path);
+    if (local != NULL) {
+        *local = env;
+    }
+    int leader_rank, n_nodes;
+    MPI_Comm_rank(leader_comm, &leader_rank);
+    MPI_Comm_size(leader_comm, &n_nodes);
+    env_fingerprint_t* all_env = NULL;
+    int* all_host_size = NULL;
+    if (leader_rank == 0) {
+        all_env = calloc((size_t)n_nodes, sizeof(env_fingerprint_t));
+        all_host_size = calloc((size_t)n_nodes, sizeof(int));
+        if (all_env == NULL || all_host_size == NULL) {
+            perror("Failed to allocate environment report");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+    }
+    MPI_Gather(&env, (int)sizeof(env_fingerprint_t), MPI_BYTE, all_env, (int)sizeof(env_fingerprint_t), MPI_BYTE, 0,
+        leader_comm);
+    MPI_Gather(&host_size, 1, MPI_INT, all_host_size, 1, MPI_INT, 0, leader_comm);
+    MPI_Comm_free(&leader_comm);
+    if (leader_rank != 0) {
+        return;
+    }
+
+    // Nodes with the same configuration are printed once, under their representative.
+    int* representative = calloc((size_t)n_nodes, sizeof(int));
+    if (representative == NULL) {
+        perror("Failed to allocate environment report");
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+    size_t n_configs = 0;
+    int n_ranks = 0;
+    for (int i = 0; i < n_nodes; i++) {
+        n_ranks += all_host_size[i];
+        representative[i] = i;
+        for (int j = 0; j < i; j++) {
+            if (representative[j] == j && env_equal(&all_env[i], &all_env[j])) {
+                representative[i] = j;
+                break;
+            }
+        }
+        n_configs += representative[i] == i;
+    }
+    fprintf(out, "# Environment: %zu distinct configuration(s) on %d node(s), %d rank(s)\n", n_configs, n_nodes,
+        n_ranks);
+    size_t config = 0;
+    for (int i = 0; i < n_nodes; i++) {
+        if (representative[i] != i) {
+            continue;
+        }
+        int config_nodes = 0;
+        int config_ranks = 0;
+        for (int j = i; j < n_nodes; j++) {
+            if (representative[j] == i) {
+                config_nodes++;
+                config_ranks += all_host_size[j];
+            }
+        }
+        fprintf(out, "# Configuration %zu: %d node(s), %d rank(s):", ++config, config_nodes, config_ranks);
+        for (int j = i; j < n_nodes; j++) {
+            if (representative[j] == i) {
+                fprintf(out, " %s", all_env[j].hostname);
+            }
+        }
+        fprintf(out, "\n");
+        write_fields(&all_env[i], 1, "#   ", out);
+    }
+    fflush(out);
+    free(representative);
+    free(all_host_size);
+    free(all_env);
+}
@@ -0,0 +1,96 @@
+#ifndef MPI_TEST_UTILS_ENVIRONMENT_H
+#define MPI_TEST_UTILS_ENVIRONMENT_H
+
+#include <mpi.h>
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @file environment.h
+ * @brief Hardware, OS, filesystem and MPI fingerprint of a node, recorded next to results
+ * so that performance differences between runs can be attributed.
+ */
+
+#define ENV_FIELD_LEN 256
+
+/*!
+ * @brief All fields are NUL-terminated strings, "unknown" if they could not be determined.
+ * The struct has no pointers, so it can be sent through MPI as bytes.
+ */
+typedef struct {
+    char hostname[ENV_FIELD_LEN];
+    char cpu_model[ENV_FIELD_LEN];
+    /*!
+     * @brief Online logical CPUs and physical cores, e.g. "64 (32 cores)".
+     */
+    char cpus[ENV_FIELD_LEN];
+    /*!
+     * @brief CPU list of every online NUMA node, e.g. "0-15 | 16-31".
+     */
+    char numa_layout[ENV_FIELD_LEN];
+    char memory[ENV_FIELD_LEN];
+    char kernel[ENV_FIELD_LEN];
+    /*!
+     * @brief Filesystem holding the test path, from /proc/self/mountinfo with statfs as fallback.
+     */
+    char fs_type[ENV_FIELD_LEN];
+    char fs_source[ENV_FIELD_LEN];
+    char fs_mount_point[ENV_FIELD_LEN];
+    /*!
+     * @brief Per-mount options, e.g. "rw,relatime".
+     */
+    char fs_mount_options[ENV_FIELD_LEN];
+    /*!
+     * @brief Superblock options of the filesystem, e.g. "rw,flock,lazystatfs".
+     */
+    char fs_super_options[ENV_FIELD_LEN];
+    /*!
+     * @brief Lustre striping of the test path, or "n/a" on other filesystems.
+     */
+    char stripe[ENV_FIELD_LEN];
+    char mpi_library[ENV_FIELD_LEN];
+} env_fingerprint_t;
+
+/*!
+ * @brief Collect the fingerprint of this node. Filesystem fields describe `path`.
+ *
+ * Does not require MPI to be initialized. Never fails; fields that cannot be read are set to "unknown".
+ */
+void env_collect(env_fingerprint_t* env, const char* path);
+
+/*!
+ * @brief Write one `<prefix><field>: <value>` line per field.
+ */
+void env_write(const env_fingerprint_t* env, const char* prefix, FILE* out);
+
+/*!
+ * @brief Parse a `<field>: <value>` line written by #env_write without its prefix.
+ * @return 0 if the line set a field, -1 otherwise.
+ */
+int env_parse_line(env_fingerprint_t* env, const char* line);
+
+/*!
+ * @brief Print the fields in which two fingerprints differ. The hostname is not compared.
+ * @return Number of differing fields.
+ */
+size_t env_diff(const env_fingerprint_t* a, const env_fingerprint_t* b, FILE* out);
+
+/*!
+ * @brief Collective. One rank per node collects its fingerprint; rank 0 of `comm` groups identical nodes
+ * and prints each distinct configuration once, with the hosts that share it, as `#`-prefixed lines.
+ *
+ * @param local Receives the fingerprint of this node on every rank. Ranks other than the one per node that
+ * takes part in the report collect it separately. May be NULL.
+ */
+void env_report(const char* path, MPI_Comm comm, env_fingerprint_t* local, FILE* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_ENVIRONMENT_H
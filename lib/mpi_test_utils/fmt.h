@@ -7,10 +7,18 @@
 
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 char* format_with_si_64(int64_t value, int precision);
 char* format_with_si_u64(uint64_t value, int precision);
 
 char* format_with_comma_64(int64_t value);
 char* format_with_comma_u64(uint64_t value);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // MPI_TEST_UTILS_FMT_H
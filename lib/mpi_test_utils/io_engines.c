@@ -0,0 +1,386 @@
+// Enable POSIX and Linux extensions (O_DIRECT)
+#define _GNU_SOURCE // NOLINT
+
+#include "mpi_test_utils/io_engines.h"
+#include "mpi_test_utils/buffer_pool.h"
+
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char* io_engine_names[] = { "stdio", "pread", "direct", "mmap", "aio" };
+
+const char* io_engine_name(io_engine_t engine) { return io_engine_names[engine]; }
+
+io_engine_t io_engine_parse(const char* name)
+{
+    for (io_engine_t engine = IO_ENGINE_STDIO; engine < IO_ENGINE_N; engine++) {
+        if (strcmp(name, io_engine_names[engine]) == 0) {
+            return engine;
+        }
+    }
+    return IO_ENGINE_N;
+}
+
+// Threads report readiness after opening their files, wait until the gate opens, and report when they are done,
+// so that the main thread can stop them at the time limit or as soon as all of them finished.
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    size_t n_ready;
+    size_t n_done;
+    bool open;
+} engine_gate_t;
+
+typedef struct {
+    const io_engine_config_t* config;
+    const char* file_name;
+    bool write;
+    int fd;
+    char* map;
+    char* buffer;
+    size_t first_block;
+    size_t n_blocks;
+    engine_gate_t* gate;
+    atomic_bool* stop;
+    int status;
+    uint64_t bytes;
+} engine_thread_t;
+
+static bool engine_stopped(const engine_thread_t* thread)
+{
+    return atomic_load_explicit(thread->stop, memory_order_relaxed);
+}
+
+static off_t block_offset(const engine_thread_t* thread, size_t i)
+{
+    return (off_t)((thread->first_block + i) * thread->config->block_size);
+}
+
+static int engine_stdio(engine_thread_t* thread, FILE* file)
+{
+    size_t block_size = thread->config->block_size;
+    if (fseeko(file, block_offset(thread, 0), SEEK_SET) != 0) {
+        perror("Failed to seek");
+        return -1;
+    }
+    for (size_t i = 0; i < thread->n_blocks && !engine_stopped(thread); i++) {
+        size_t done = thread->write ? fwrite(thread->buffer, 1, block_size, file)
+                                    : fread(thread->buffer, 1, block_size, file);
+        if (done != block_size) {
+            perror(thread->write ? "Failed to write data" : "Failed to read data");
+            return -1;
+        }
+        thread->bytes += block_size;
+    }
+    if (thread->write && fflush(file) != 0) {
+        perror("Failed to flush data");
+        return -1;
+    }
+    return 0;
+}
+
+static int engine_pread(engine_thread_t* thread)
+{
+    size_t block_size = thread->config->block_size;
+    for (size_t i = 0; i < thread->n_blocks && !engine_stopped(thread); i++) {
+        off_t offset = block_offset(thread, i);
+        ssize_t done = thread->write ? pwrite(thread->fd, thread->buffer, block_size, offset)
+                                     : pread(thread->fd, thread->buffer, block_size, offset);
+        if (done != (ssize_t)block_size) {
+            perror(thread->write ? "Failed to write data" : "Failed to read data");
+            return -1;
+        }
+        thread->bytes += block_size;
+    }
+    return 0;
+}
+
+static int engine_mmap(engine_thread_t* thread)
+{
+    size_t block_size = thread->config->block_size;
+    for (size_t i = 0; i < thread->n_blocks && !engine_stopped(thread); i++) {
+        char* block = thread->map + block_offset(thread, i);
+        if (thread->write) {
+            memcpy(block, thread->buffer, block_size);
+        } else {
+            memcpy(thread->buffer, block, block_size);
+        }
+        thread->bytes += block_size;
+    }
+    return 0;
+}
+
+// Keep up to `queue_depth` requests in flight; request i lives in slot i % queue_depth.
+// Every request of a thread shares its buffer, as in test_sequential_write_libaio.
+static int engine_aio(engine_thread_t* thread)
+{
+    size_t block_size = thread->config->block_size;
+    size_t depth = thread->config->queue_depth == 0 ? 1 : thread->config->queue_depth;
+    struct aiocb* cbs = calloc(depth, sizeof(struct aiocb));
+    if (cbs == NULL) {
+        perror("Failed to allocate aiocb array");
+        return -1;
+    }
+    int status = 0;
+    size_t submitted = 0;
+    size_t completed = 0;
+    for (;;) {
+        bool can_submit = status == 0 && submitted < thread->n_blocks && !engine_stopped(thread);
+        if (can_submit && submitted - completed < depth) {
+            struct aiocb* cb = &cbs[submitted % depth];
+            memset(cb, 0, sizeof(struct aiocb));
+            cb->aio_fildes = thread->fd;
+            cb->aio_buf = thread->buffer;
+            cb->aio_nbytes = block_size;
+            cb->aio_offset = block_offset(thread, submitted);
+            if ((thread->write ? aio_write(cb) : aio_read(cb)) != 0) {
+                perror("Failed to submit AIO request");
+                status = -1;
+            } else {
+                submitted++;
+            }
+            continue;
+        }
+        if (completed == submitted) {
+            break;
+        }
+        // Wait for the oldest request, which frees its slot.
+        struct aiocb* cb = &cbs[completed % depth];
+        const struct aiocb* wait_list[1] = { cb };
+        while (aio_error(cb) == EINPROGRESS) {
+            aio_suspend(wait_list, 1, NULL);
+        }
+        int err = aio_error(cb);
+        ssize_t ret = aio_return(cb);
+        if (err != 0 || ret != (ssize_t)block_size) {
+            fprintf(stderr, "AIO request %zu failed: %s\n", completed, err != 0 ? strerror(err) : "short transfer");
+            status = -1;
+        } else {
+            thread->bytes += block_size;
+        }
+        completed++;
+    }
+    free(cbs);
+    return status;
+}
+
+static void* engine_thread_main(void* arg)
+{
+    engine_thread_t* thread = arg;
+    // stdio streams are not shared between threads, so each thread opens its own.
+    FILE* file = NULL;
+    if (thread->config->engine == IO_ENGINE_STDIO) {
+        file = fopen(thread->file_name, thread->write ? "r+be" : "rbe");
+        if (file == NULL) {
+            perror("Failed to open file");
+            thread->status = -1;
+        }
+    }
+
+    engine_gate_t* gate = thread->gate;
+    pthread_mutex_lock(&gate->mutex);
+    gate->n_ready++;
+    pthread_cond_broadcast(&gate->cond);
+    while (!gate->open) {
+        pthread_cond_wait(&gate->cond, &gate->mutex);
+    }
+    pthread_mutex_unlock(&gate->mutex);
+
+    if (thread->status == 0) {
+        switch (thread->config->engine) {
+        case IO_ENGINE_STDIO:
+            thread->status = engine_stdio(thread, file);
+            break;
+        case IO_ENGINE_PREAD:
+        case IO_ENGINE_DIRECT:
+            thread->status = engine_pread(thread);
+            break;
+        case IO_ENGINE_MMAP:
+            thread->status = engine_mmap(thread);
+            break;
+        case IO_ENGINE_AIO:
+            thread->status = engine_aio(thread);
+            break;
+        default:
+            thread->status = -1;
+            break;
+        }
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+
+    pthread_mutex_lock(&gate->mutex);
+    gate->n_done++;
+    pthread_cond_broadcast(&gate->cond);
+    pthread_mutex_unlock(&gate->mutex);
+    return NULL;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+// Wait until all started threads are done or the time limit is reached, then stop the remaining ones.
+static void wait_for_threads(engine_gate_t* gate, size_t n_started, uint64_t start_ns, uint64_t time_limit_ns,
+    atomic_bool* stop)
+{
+    uint64_t deadline_ns = start_ns + time_limit_ns;
+    struct timespec deadline = { (time_t)(deadline_ns / 1000000000), (long)(deadline_ns % 1000000000) };
+    pthread_mutex_lock(&gate->mutex);
+    while (gate->n_done < n_started) {
+        if (time_limit_ns == 0) {
+            pthread_cond_wait(&gate->cond, &gate->mutex);
+        } else if (pthread_cond_timedwait(&gate->cond, &gate->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&gate->mutex);
+    atomic_store(stop, true);
+}
+
+ssize_t test_engine_nompi(
+    const char* file_name, const io_engine_config_t* config, bool write, size_t file_size, uint64_t* bytes)
+{
+    *bytes = 0;
+    size_t n_threads = config->n_threads == 0 ? 1 : config->n_threads;
+    size_t block_size = config->block_size;
+    if (config->engine >= IO_ENGINE_N || block_size == 0 || file_size / block_size < n_threads) {
+        fprintf(stderr, "Invalid engine, or fewer than one %zu-byte block per thread\n", block_size);
+        return -1;
+    }
+    size_t n_blocks = file_size / block_size;
+    size_t mapped = n_blocks * block_size;
+
+    int flags = write ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY;
+    if (config->engine == IO_ENGINE_DIRECT) {
+        flags |= O_DIRECT;
+    }
+    int fd = open(file_name, flags | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        perror("Failed to open file");
+        return -1;
+    }
+    char* map = NULL;
+    if (config->engine == IO_ENGINE_MMAP) {
+        if (write && ftruncate(fd, (off_t)mapped) != 0) {
+            perror("Failed to extend file");
+            close(fd);
+            return -1;
+        }
+        map = mmap(NULL, mapped, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            perror("Failed to map file");
+            close(fd);
+            return -1;
+        }
+    }
+
+    engine_thread_t* threads = calloc(n_threads, sizeof(engine_thread_t));
+    pthread_t* tids = calloc(n_threads, sizeof(pthread_t));
+    if (threads == NULL || tids == NULL) {
+        perror("Failed to allocate threads");
+        free(threads);
+        free(tids);
+        if (map != NULL) {
+            munmap(map, mapped);
+        }
+        close(fd);
+        return -1;
+    }
+    engine_gate_t gate = { .n_ready = 0, .n_done = 0, .open = false };
+    pthread_mutex_init(&gate.mutex, NULL);
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&gate.cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    atomic_bool stop;
+    atomic_init(&stop, false);
+
+    size_t per_thread = n_blocks / n_threads;
+    size_t n_started = 0;
+    for (size_t i = 0; i < n_threads; i++) {
+        engine_thread_t* thread = &threads[i];
+        thread->config = config;
+        thread->file_name = file_name;
+        thread->write = write;
+        thread->fd = fd;
+        thread->map = map;
+        thread->first_block = i * per_thread;
+        thread->n_blocks = i + 1 == n_threads ? n_blocks - thread->first_block : per_thread;
+        thread->gate = &gate;
+        thread->stop = &stop;
+        // Buffers are mapped here, before the clock starts.
+        thread->buffer = buffer_pool_get(buffer_pool_shared(), BUFFER_SLOT_THREADS + i, block_size);
+        if (thread->buffer == NULL) {
+            thread->status = -1;
+            break;
+        }
+        if (pthread_create(&tids[i], NULL, engine_thread_main, thread) != 0) {
+            perror("Failed to create thread");
+            thread->status = -1;
+            break;
+        }
+        n_started++;
+    }
+    if (n_started < n_threads) {
+        // Let the threads already started leave right away.
+        atomic_store(&stop, true);
+    }
+
+    pthread_mutex_lock(&gate.mutex);
+    while (gate.n_ready < n_started) {
+        pthread_cond_wait(&gate.cond, &gate.mutex);
+    }
+    uint64_t start = now_ns();
+    gate.open = true;
+    pthread_cond_broadcast(&gate.cond);
+    pthread_mutex_unlock(&gate.mutex);
+
+    wait_for_threads(&gate, n_started, start, config->time_limit_ns, &stop);
+    for (size_t i = 0; i < n_started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    int status = 0;
+    for (size_t i = 0; i < n_threads; i++) {
+        if (threads[i].status != 0) {
+            status = -1;
+        }
+        *bytes += threads[i].bytes;
+    }
+    if (status == 0 && write && config->sync) {
+        int synced = map != NULL ? msync(map, mapped, MS_SYNC) : fdatasync(fd);
+        if (synced != 0) {
+            perror("Failed to sync data");
+            status = -1;
+        }
+    }
+    uint64_t elapsed_ns = now_ns() - start;
+
+    pthread_cond_destroy(&gate.cond);
+    pthread_mutex_destroy(&gate.mutex);
+    free(threads);
+    free(tids);
+    if (map != NULL) {
+        munmap(map, mapped);
+    }
+    close(fd);
+    return status == 0 ? (ssize_t)elapsed_ns : -1;
+}
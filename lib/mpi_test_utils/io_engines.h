@@ -0,0 +1,84 @@
+#ifndef MPI_TEST_UTILS_IO_ENGINES_H
+#define MPI_TEST_UTILS_IO_ENGINES_H
+
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @file io_engines.h
+ * @brief One parameterised transfer test over all I/O engines, so that configurations can be compared
+ * and searched programmatically.
+ */
+
+typedef enum {
+    /*!
+     * @brief fread/fwrite with the default stdio buffer.
+     */
+    IO_ENGINE_STDIO,
+    IO_ENGINE_PREAD,
+    /*!
+     * @brief pread/pwrite with O_DIRECT. Block sizes must be multiples of the logical block size.
+     */
+    IO_ENGINE_DIRECT,
+    /*!
+     * @brief memcpy to or from a shared mapping of the file.
+     */
+    IO_ENGINE_MMAP,
+    /*!
+     * @brief POSIX AIO with `queue_depth` requests in flight per thread.
+     */
+    IO_ENGINE_AIO,
+    IO_ENGINE_N
+} io_engine_t;
+
+const char* io_engine_name(io_engine_t engine);
+
+/*!
+ * @return The engine called `name` by #io_engine_name, or IO_ENGINE_N if there is none.
+ */
+io_engine_t io_engine_parse(const char* name);
+
+typedef struct {
+    io_engine_t engine;
+    size_t block_size;
+    /*!
+     * @brief Requests in flight per thread. Only used by #IO_ENGINE_AIO.
+     */
+    size_t queue_depth;
+    size_t n_threads;
+    /*!
+     * @brief Flush written data to storage before the timed region ends: fdatasync, or msync for mmap.
+     */
+    bool sync;
+    /*!
+     * @brief Stop transferring after this many nanoseconds, 0 for no limit.
+     */
+    uint64_t time_limit_ns;
+} io_engine_config_t;
+
+/*!
+ * @brief Write or read `file_size` bytes of `file_name` in blocks. Each thread transfers a contiguous share.
+ *
+ * Writes create or truncate the file. Reads expect it to hold at least `file_size` bytes.
+ * All threads are released together; the timed region ends when the last one finishes or the time limit is reached.
+ *
+ * @param bytes Receives the number of bytes transferred, less than `file_size` if the time limit was reached.
+ * @return Elapsed time in nanoseconds, or -1 on failure.
+ */
+ssize_t test_engine_nompi(
+    const char* file_name, const io_engine_config_t* config, bool write, size_t file_size, uint64_t* bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_IO_ENGINES_H
@@ -1,93 +1,165 @@
 //
 // Created by yuzj on 12/16/25.
 //
-// Enable POSIX extensions
-#define _POSIX_C_SOURCE 200809L // NOLINT
+// Enable POSIX and Linux extensions (preadv/pwritev)
+#define _GNU_SOURCE // NOLINT
 
 #include "mpi_test_utils/io_tester.h"
+#include "mpi_test_utils/buffer_pool.h"
+#include "mpi_test_utils/constants.h"
 #include "mpi_test_utils/pcg_basic.h"
+#include "mpi_test_utils/perf_counters.h"
+#include "mpi_test_utils/timeline.h"
+#include "mpi_test_utils/uring.h"
+
+#ifdef MPI_TEST_UTILS_HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
 
 #include <aio.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <time.h>
 #include <unistd.h>
 
-ssize_t test_sequential_write_nompi(const char* file_name, size_t block_size, size_t n_blocks)
+#define SMALL_FILE_PATH_LEN 4096
+#define SMALL_FILE_BATCH 64
+
+static struct {
+    bool perf_enabled;
+    perf_sample_t last_perf;
+    timeline_t* timeline;
+    size_t stdio_buffer;
+} IO = { .stdio_buffer = IO_STDIO_BUFFER_DEFAULT };
+
+typedef struct {
+    struct timespec start;
+    perf_region_t perf;
+} timed_region_t;
+
+// perror may itself change errno, but callers such as io_tester.hpp read it after a test fails.
+static void report_error(const char* what)
 {
-    // Open file for writing
-    FILE* file = fopen(file_name, "wbe");
-    if (file == NULL) {
-        perror("Failed to open file for writing");
-        return -1;
-    }
-    // Allocate buffer
-    char* buffer = (char*)calloc(block_size, sizeof(char));
-    if (buffer == NULL) {
-        perror("Failed to allocate buffer");
-        fclose(file);
-        return -1;
+    int err = errno;
+    perror(what);
+    errno = err;
+}
+
+void io_tester_set_perf(bool enable) { IO.perf_enabled = enable; }
+
+const perf_sample_t* io_tester_last_perf(void) { return &IO.last_perf; }
+
+void io_tester_set_timeline(timeline_t* timeline) { IO.timeline = timeline; }
+
+void io_tester_set_stdio_buffer(size_t size) { IO.stdio_buffer = size; }
+
+// Data buffer of all engines. It is mapped and prefaulted by the first test that needs it
+// and reused by later tests, so that no allocation happens inside or between timed loops.
+static char* io_buffer(size_t size)
+{
+    return (char*)buffer_pool_get(buffer_pool_shared(), BUFFER_SLOT_IO, size == 0 ? 1 : size);
+}
+
+// Apply the buffer size set with io_tester_set_stdio_buffer. Must precede any other operation on `file`.
+static int set_stdio_buffer(FILE* file)
+{
+    if (IO.stdio_buffer == IO_STDIO_BUFFER_DEFAULT) {
+        return 0;
     }
-    // Write
-    // Get start time
-    struct timespec start, end;
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    for (size_t i = 0; i < n_blocks; i++) {
-        size_t written = fwrite(buffer, sizeof(char), block_size, file);
-        if (written != block_size) {
-            perror("Failed to write data");
-            free(buffer);
-            fclose(file);
+    char* buffer = NULL;
+    if (IO.stdio_buffer > 0) {
+        buffer = buffer_pool_get(buffer_pool_shared(), BUFFER_SLOT_STDIO, IO.stdio_buffer);
+        if (buffer == NULL) {
             return -1;
         }
     }
-    // Get end time
+    if (setvbuf(file, buffer, buffer == NULL ? _IONBF : _IOFBF, IO.stdio_buffer) != 0) {
+        report_error("Failed to set stream buffer");
+        return -1;
+    }
+    return 0;
+}
+
+static void timed_region_begin(timed_region_t* region)
+{
+    if (IO.perf_enabled) {
+        perf_region_begin(&region->perf);
+    }
+    if (IO.timeline != NULL && timeline_start(IO.timeline) != 0) {
+        // Detach rather than report an empty timeline as the run's.
+        fprintf(stderr, "Timeline disabled\n");
+        IO.timeline = NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &region->start);
+}
+
+static ssize_t timed_region_end(timed_region_t* region)
+{
+    struct timespec end;
     clock_gettime(CLOCK_MONOTONIC, &end);
+    if (IO.timeline != NULL) {
+        timeline_stop(IO.timeline);
+    }
+    if (IO.perf_enabled) {
+        perf_region_end(&region->perf, &IO.last_perf);
+    }
     // Calculate elapsed time in nanosecs
-    ssize_t elapsed_ns = (end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec);
-    // Clean up
-    free(buffer);
-    fclose(file);
-    return elapsed_ns;
+    return (end.tv_sec - region->start.tv_sec) * 1000000000 + (end.tv_nsec - region->start.tv_nsec);
+}
+
+static void timed_region_cancel(timed_region_t* region)
+{
+    if (IO.timeline != NULL) {
+        timeline_stop(IO.timeline);
+    }
+    if (IO.perf_enabled) {
+        perf_region_cancel(&region->perf);
+    }
+}
+
+ssize_t test_sequential_write_nompi(const char* file_name, size_t block_size, size_t n_blocks)
+{
+    return test_sequential_write_stdio_sync_nompi(file_name, block_size, n_blocks, SYNC_NONE, 1);
 }
 ssize_t test_sequential_read_nompi(const char* file_name, size_t block_size, size_t n_blocks)
 {
     // Open file for reading
     FILE* file = fopen(file_name, "rbe");
     if (file == NULL) {
-        perror("Failed to open file for reading");
+        report_error("Failed to open file for reading");
         return -1;
     }
     // Allocate buffer
-    char* buffer = (char*)calloc(block_size, sizeof(char));
-    if (buffer == NULL) {
-        perror("Failed to allocate buffer");
+    char* buffer = io_buffer(block_size);
+    if (buffer == NULL || set_stdio_buffer(file) != 0) {
         fclose(file);
         return -1;
     }
     // Read
     // Get start time
-    struct timespec start, end;
-    clock_gettime(CLOCK_MONOTONIC, &start);
+    timed_region_t region;
+    timed_region_begin(&region);
     for (size_t i = 0; i < n_blocks; i++) {
         size_t read = fread(buffer, sizeof(char), block_size, file);
         if (read != block_size) {
-            perror("Failed to read data");
-            free(buffer);
+            report_error("Failed to read data");
+            timed_region_cancel(&region);
             fclose(file);
             return -1;
         }
+        timeline_add(IO.timeline, block_size);
     }
     // Get end time
-    clock_gettime(CLOCK_MONOTONIC, &end);
-    // Calculate elapsed time in nanosecs
-    ssize_t elapsed_ns = (end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec);
+    ssize_t elapsed_ns = timed_region_end(&region);
     // Clean up
-    free(buffer);
     fclose(file);
     return elapsed_ns;
 }
@@ -98,22 +170,21 @@ ssize_t test_random_read_nompi(const char* file_name, size_t block_size, size_t
     // Open file for reading
     FILE* file = fopen(file_name, "rbe");
     if (file == NULL) {
-        perror("Failed to open file for reading");
+        report_error("Failed to open file for reading");
         free(rng);
         return -1;
     }
     // Allocate buffer
-    char* buffer = (char*)calloc(block_size, sizeof(char));
-    if (buffer == NULL) {
-        perror("Failed to allocate buffer");
+    char* buffer = io_buffer(block_size);
+    if (buffer == NULL || set_stdio_buffer(file) != 0) {
         fclose(file);
         free(rng);
         return -1;
     }
     // Read
     // Get start time
-    struct timespec start, end;
-    clock_gettime(CLOCK_MONOTONIC, &start);
+    timed_region_t region;
+    timed_region_begin(&region);
     for (size_t i = 0; i < n_reads; i++) {
         size_t rand_block_idx = pcg32_boundedrand_r(rng, (uint32_t)n_blocks);
         size_t offset = rand_block_idx * block_size;
@@ -121,92 +192,131 @@ ssize_t test_random_read_nompi(const char* file_name, size_t block_size, size_t
             offset += pcg32_boundedrand_r(rng, block_size);
         }
         if (fseek(file, offset, SEEK_SET) != 0) {
-            perror("Failed to seek to position");
-            free(buffer);
+            report_error("Failed to seek to position");
+            timed_region_cancel(&region);
             fclose(file);
             free(rng);
             return -1;
         }
         size_t read = fread(buffer, sizeof(char), block_size, file);
         if (read != block_size) {
-            perror("Failed to read data");
-            free(buffer);
+            report_error("Failed to read data");
+            timed_region_cancel(&region);
             fclose(file);
             free(rng);
             return -1;
         }
+        timeline_add(IO.timeline, block_size);
     }
     // Get end time
-    clock_gettime(CLOCK_MONOTONIC, &end);
-    // Calculate elapsed time in nanosecs
-    ssize_t elapsed_ns = (end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec);
+    ssize_t elapsed_ns = timed_region_end(&region);
     // Clean up
-    free(buffer);
     fclose(file);
     free(rng);
     return elapsed_ns;
 }
-ssize_t test_sequential_write_libaio(const char* file_name, size_t block_size, size_t n_blocks)
+ssize_t test_sequential_read_syscall_nompi(const char* file_name, size_t block_size, size_t n_blocks)
 {
-    int fd = open(file_name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_APPEND, S_IRUSR | S_IWUSR);
+    int fd = open(file_name, O_RDONLY | O_CLOEXEC);
     if (fd == -1) {
-        perror("Failed to open file for writing");
+        report_error("Failed to open file for reading");
         return -1;
     }
-
-    struct aiocb** cbs = calloc(n_blocks, sizeof(struct aiocb*));
-    if (cbs == NULL) {
-        perror("Failed to allocate aiocb array");
+    char* buffer = io_buffer(block_size);
+    if (buffer == NULL) {
         close(fd);
         return -1;
     }
-
+    timed_region_t region;
+    timed_region_begin(&region);
     for (size_t i = 0; i < n_blocks; i++) {
-        cbs[i] = calloc(1, sizeof(struct aiocb));
-        if (cbs[i] == NULL) {
-            perror("Failed to allocate aiocb");
-            for (size_t j = 0; j < i; j++) {
-                free((void*)cbs[j]->aio_buf);
-                free(cbs[j]);
-            }
-            free(cbs);
+        if (read(fd, buffer, block_size) != (ssize_t)block_size) {
+            report_error("Failed to read data");
+            timed_region_cancel(&region);
             close(fd);
             return -1;
         }
-
-        char* buffer = calloc(block_size, sizeof(char));
-        if (buffer == NULL) {
-            perror("Failed to allocate buffer");
-            for (size_t j = 0; j < i; j++) {
-                free((void*)cbs[j]->aio_buf);
-                free(cbs[j]);
-            }
-            free(cbs[i]);
-            free(cbs);
+        timeline_add(IO.timeline, block_size);
+    }
+    ssize_t elapsed_ns = timed_region_end(&region);
+    close(fd);
+    return elapsed_ns;
+}
+ssize_t test_random_read_syscall_nompi(const char* file_name, size_t block_size, size_t n_blocks, size_t n_reads)
+{
+    pcg32_random_t rng;
+    pcg32_srandom_r(&rng, (uint64_t)time(NULL), (uint64_t)(uintptr_t)&rng);
+    int fd = open(file_name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        report_error("Failed to open file for reading");
+        return -1;
+    }
+    char* buffer = io_buffer(block_size);
+    if (buffer == NULL) {
+        close(fd);
+        return -1;
+    }
+    timed_region_t region;
+    timed_region_begin(&region);
+    for (size_t i = 0; i < n_reads; i++) {
+        // Unaligned offsets, as in test_random_read_nompi.
+        size_t rand_block_idx = pcg32_boundedrand_r(&rng, (uint32_t)n_blocks);
+        size_t offset = rand_block_idx * block_size;
+        if (rand_block_idx != (n_blocks - 1)) {
+            offset += pcg32_boundedrand_r(&rng, block_size);
+        }
+        if (pread(fd, buffer, block_size, (off_t)offset) != (ssize_t)block_size) {
+            report_error("Failed to read data");
+            timed_region_cancel(&region);
             close(fd);
             return -1;
         }
+        timeline_add(IO.timeline, block_size);
+    }
+    ssize_t elapsed_ns = timed_region_end(&region);
+    close(fd);
+    return elapsed_ns;
+}
+ssize_t test_sequential_write_libaio(const char* file_name, size_t block_size, size_t n_blocks)
+{
+    int fd = open(file_name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_APPEND, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        report_error("Failed to open file for writing");
+        return -1;
+    }
+
+    // Every request writes the same content, so all of them share one buffer.
+    char* buffer = io_buffer(block_size);
+    struct aiocb* cbs = calloc(n_blocks == 0 ? 1 : n_blocks, sizeof(struct aiocb));
+    if (buffer == NULL || cbs == NULL) {
+        report_error("Failed to allocate aiocb array");
+        free(cbs);
+        close(fd);
+        return -1;
+    }
 
+    for (size_t i = 0; i < n_blocks; i++) {
         /* Initialize aiocb (calloc already zeroes it) */
-        cbs[i]->aio_fildes = fd;
-        cbs[i]->aio_buf = buffer;
-        cbs[i]->aio_nbytes = block_size;
-        // cbs[i]->aio_offset = (off_t)(i * block_size); /* explicit non-overlapping offsets */
-        // cbs[i]->aio_sigevent.sigev_notify = SIGEV_NONE;
+        cbs[i].aio_fildes = fd;
+        cbs[i].aio_buf = buffer;
+        cbs[i].aio_nbytes = block_size;
+        // cbs[i].aio_offset = (off_t)(i * block_size); /* explicit non-overlapping offsets */
+        // cbs[i].aio_sigevent.sigev_notify = SIGEV_NONE;
     }
 
-    struct timespec start, end;
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    struct sigevent sig = { 0, 0 };
+    timed_region_t region;
+    timed_region_begin(&region);
 
     // Write
     for (size_t i = 0; i < n_blocks; i++) {
-        if (aio_write(cbs[i]) == -1) {
-            perror("Failed to submit AIO write");
-            for (size_t j = 0; j <= i; j++) {
-                free((void*)cbs[j]->aio_buf);
-                free(cbs[j]);
+        if (aio_write(&cbs[i]) == -1) {
+            report_error("Failed to submit AIO write");
+            // Requests already in flight still reference the aiocbs.
+            for (size_t j = 0; j < i; j++) {
+                while (aio_error(&cbs[j]) == EINPROGRESS) { }
+                aio_return(&cbs[j]);
             }
+            timed_region_cancel(&region);
             free(cbs);
             close(fd);
             return -1;
@@ -217,30 +327,513 @@ ssize_t test_sequential_write_libaio(const char* file_name, size_t block_size, s
     for (size_t i = 0; i < n_blocks; i++) {
         int err = EINPROGRESS;
         while (err == EINPROGRESS) {
-            err = aio_error(cbs[i]);
+            err = aio_error(&cbs[i]);
         }
 
         if (err != 0) {
             fprintf(stderr, "AIO write error for request %zu: %s\n", i, strerror(err));
         } else {
-            ssize_t ret = aio_return(cbs[i]);
+            ssize_t ret = aio_return(&cbs[i]);
             if (ret != (ssize_t)block_size) {
                 fprintf(stderr, "AIO write returned %zd bytes for request %zu (expected %zu)\n", ret, i, block_size);
             }
+            timeline_add(IO.timeline, (uint64_t)ret);
         }
     }
 
-    clock_gettime(CLOCK_MONOTONIC, &end);
-    ssize_t elapsed_ns = (end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec);
+    ssize_t elapsed_ns = timed_region_end(&region);
+
+    free(cbs);
+    close(fd);
+    return elapsed_ns;
+}
+
+const char* sync_policy_name(sync_policy_t policy)
+{
+    static const char* names[] = { "none", "fsync_end", "fdatasync_every_n", "o_dsync", "sync_file_range" };
+    return names[policy];
+}
+
+// Start asynchronous writeback of the latest window and wait for the previous one,
+// so that flushing overlaps with writing the next window.
+static int sync_window(int fd, off_t window_start, off_t window_len, off_t* pending_start, off_t* pending_len)
+{
+    if (*pending_len > 0
+        && sync_file_range(fd, *pending_start, *pending_len,
+               SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER)
+            != 0) {
+        report_error("Failed to wait for writeback");
+        return -1;
+    }
+    if (sync_file_range(fd, window_start, window_len, SYNC_FILE_RANGE_WRITE) != 0) {
+        report_error("Failed to start writeback");
+        return -1;
+    }
+    *pending_start = window_start;
+    *pending_len = window_len;
+    return 0;
+}
+
+static bool syncs_every_interval(sync_policy_t policy)
+{
+    return policy == SYNC_FDATASYNC_EVERY_N || policy == SYNC_FILE_RANGE;
+}
+
+// Make the interval of `interval_len` bytes ending at `end` durable, or start its writeback.
+static int sync_interval_end(
+    int fd, sync_policy_t policy, size_t end, size_t interval_len, off_t* pending_start, off_t* pending_len)
+{
+    if (policy == SYNC_FDATASYNC_EVERY_N && fdatasync(fd) != 0) {
+        report_error("Failed to sync data");
+        return -1;
+    }
+    if (policy == SYNC_FILE_RANGE) {
+        return sync_window(fd, (off_t)(end - interval_len), (off_t)interval_len, pending_start, pending_len);
+    }
+    return 0;
+}
+
+// sync_file_range does not flush metadata or device caches, so every flushing policy ends with a full sync.
+static int sync_last(int fd, sync_policy_t policy)
+{
+    if (policy == SYNC_FSYNC_END && fsync(fd) != 0) {
+        report_error("Failed to sync file");
+        return -1;
+    }
+    if (syncs_every_interval(policy) && fdatasync(fd) != 0) {
+        report_error("Failed to sync data");
+        return -1;
+    }
+    return 0;
+}
+
+static int open_sync_target(const char* file_name, sync_policy_t policy)
+{
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (policy == SYNC_O_DSYNC) {
+        flags |= O_DSYNC;
+    }
+    int fd = open(file_name, flags, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        report_error("Failed to open file for writing");
+    }
+    return fd;
+}
 
-    /* Clean up all allocations */
+ssize_t test_sequential_write_sync_nompi(
+    const char* file_name, size_t block_size, size_t n_blocks, sync_policy_t policy, size_t sync_interval)
+{
+    if (sync_interval == 0) {
+        sync_interval = 1;
+    }
+    int fd = open_sync_target(file_name, policy);
+    if (fd == -1) {
+        return -1;
+    }
+    // Allocate buffer
+    char* buffer = io_buffer(block_size);
+    if (buffer == NULL) {
+        close(fd);
+        return -1;
+    }
+    off_t pending_start = 0;
+    off_t pending_len = 0;
+    // Write, and make data durable according to the policy inside the timed region
+    timed_region_t region;
+    timed_region_begin(&region);
     for (size_t i = 0; i < n_blocks; i++) {
-        if (cbs[i]) {
-            free((void*)cbs[i]->aio_buf);
-            free(cbs[i]);
+        if (write(fd, buffer, block_size) != (ssize_t)block_size) {
+            report_error("Failed to write data");
+            goto fail;
+        }
+        timeline_add(IO.timeline, block_size);
+        if (syncs_every_interval(policy) && (i + 1) % sync_interval == 0
+            && sync_interval_end(fd, policy, (i + 1) * block_size, sync_interval * block_size, &pending_start,
+                   &pending_len)
+                != 0) {
+            goto fail;
         }
     }
-    free(cbs);
+    if (sync_last(fd, policy) != 0) {
+        goto fail;
+    }
+    ssize_t elapsed_ns = timed_region_end(&region);
     close(fd);
     return elapsed_ns;
+fail:
+    timed_region_cancel(&region);
+    close(fd);
+    return -1;
+}
+
+ssize_t test_sequential_write_stdio_sync_nompi(
+    const char* file_name, size_t block_size, size_t n_blocks, sync_policy_t policy, size_t sync_interval)
+{
+    if (sync_interval == 0) {
+        sync_interval = 1;
+    }
+    int fd = open_sync_target(file_name, policy);
+    if (fd == -1) {
+        return -1;
+    }
+    FILE* file = fdopen(fd, "wb");
+    if (file == NULL) {
+        report_error("Failed to open file for writing");
+        close(fd);
+        return -1;
+    }
+    // Allocate buffer
+    char* buffer = io_buffer(block_size);
+    if (buffer == NULL || set_stdio_buffer(file) != 0) {
+        fclose(file);
+        return -1;
+    }
+    off_t pending_start = 0;
+    off_t pending_len = 0;
+    // Write, and make data durable according to the policy inside the timed region
+    timed_region_t region;
+    timed_region_begin(&region);
+    for (size_t i = 0; i < n_blocks; i++) {
+        size_t written = fwrite(buffer, sizeof(char), block_size, file);
+        if (written != block_size) {
+            report_error("Failed to write data");
+            goto fail;
+        }
+        timeline_add(IO.timeline, block_size);
+        if (!syncs_every_interval(policy) || (i + 1) % sync_interval != 0) {
+            continue;
+        }
+        // The kernel can only sync what the stream has already handed to it.
+        if (fflush(file) != 0) {
+            report_error("Failed to flush data");
+            goto fail;
+        }
+        if (sync_interval_end(fd, policy, (i + 1) * block_size, sync_interval * block_size, &pending_start,
+                &pending_len)
+            != 0) {
+            goto fail;
+        }
+    }
+    // Hand what is left in the stream buffer to the kernel, so that all data is written inside the timed region
+    if (fflush(file) != 0) {
+        report_error("Failed to flush data");
+        goto fail;
+    }
+    if (sync_last(fd, policy) != 0) {
+        goto fail;
+    }
+    ssize_t elapsed_ns = timed_region_end(&region);
+    fclose(file);
+    return elapsed_ns;
+fail:
+    timed_region_cancel(&region);
+    fclose(file);
+    return -1;
+}
+
+const char* small_file_variant_name(small_file_variant_t variant)
+{
+    static const char* names[] = { "syscall", "vectored", "io_uring" };
+    return names[variant];
+}
+
+bool small_file_variant_available(small_file_variant_t variant)
+{
+    if (variant != SMALL_FILE_IO_URING) {
+        return true;
+    }
+    uring_t ring;
+    if (uring_init(&ring, 1) != 0) {
+        // Other errors, e.g. hitting RLIMIT_MEMLOCK, are left for the test to report.
+        return errno != ENOSYS && errno != EPERM && errno != EINVAL;
+    }
+    uring_exit(&ring);
+    return true;
+}
+
+static void small_file_path(char* path, const char* dir, size_t idx)
+{
+    snprintf(path, SMALL_FILE_PATH_LEN, "%s/small.%zu", dir, idx);
+}
+
+void small_file_remove(const char* dir, size_t n_files)
+{
+    char path[SMALL_FILE_PATH_LEN];
+    for (size_t i = 0; i < n_files; i++) {
+        small_file_path(path, dir, i);
+        unlink(path);
+    }
+}
+
+static int open_small_file(const char* path, bool write)
+{
+    int fd = write ? open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR)
+                   : open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        report_error(write ? "Failed to open file for writing" : "Failed to open file for reading");
+    }
+    return fd;
+}
+
+static int finish_small_file(int fd, bool write, bool sync_files)
+{
+    if (write && sync_files && fsync(fd) != 0) {
+        report_error("Failed to sync file");
+        close(fd);
+        return -1;
+    }
+    if (close(fd) != 0) {
+        report_error("Failed to close file");
+        return -1;
+    }
+    return 0;
+}
+
+// One read(2)/write(2) per block.
+static int small_files_syscall(
+    const char* dir, char* buffer, size_t file_size, size_t n_files, bool write, bool sync_files)
+{
+    char path[SMALL_FILE_PATH_LEN];
+    for (size_t i = 0; i < n_files; i++) {
+        small_file_path(path, dir, i);
+        int fd = open_small_file(path, write);
+        if (fd == -1) {
+            return -1;
+        }
+        for (size_t offset = 0; offset < file_size; offset += BLOCK_SIZE) {
+            size_t len = file_size - offset < BLOCK_SIZE ? file_size - offset : BLOCK_SIZE;
+            ssize_t done = write ? pwrite(fd, buffer + offset, len, (off_t)offset)
+                                 : pread(fd, buffer + offset, len, (off_t)offset);
+            if (done != (ssize_t)len) {
+                report_error(write ? "Failed to write data" : "Failed to read data");
+                close(fd);
+                return -1;
+            }
+        }
+        if (finish_small_file(fd, write, sync_files) != 0) {
+            return -1;
+        }
+        timeline_add(IO.timeline, file_size);
+    }
+    return 0;
+}
+
+// The blocks of each file are gathered into a single preadv(2)/pwritev(2).
+static int small_files_vectored(
+    const char* dir, char* buffer, size_t file_size, size_t n_files, bool write, bool sync_files)
+{
+    size_t chunk = BLOCK_SIZE;
+    if ((file_size + chunk - 1) / chunk > IOV_MAX) {
+        chunk = (file_size + IOV_MAX - 1) / IOV_MAX;
+    }
+    size_t n_iov = (file_size + chunk - 1) / chunk;
+    struct iovec* iov = calloc(n_iov == 0 ? 1 : n_iov, sizeof(struct iovec));
+    if (iov == NULL) {
+        report_error("Failed to allocate iovec");
+        return -1;
+    }
+    for (size_t j = 0; j < n_iov; j++) {
+        iov[j].iov_base = buffer + j * chunk;
+        iov[j].iov_len = file_size - j * chunk < chunk ? file_size - j * chunk : chunk;
+    }
+    char path[SMALL_FILE_PATH_LEN];
+    for (size_t i = 0; i < n_files; i++) {
+        small_file_path(path, dir, i);
+        int fd = open_small_file(path, write);
+        if (fd == -1) {
+            free(iov);
+            return -1;
+        }
+        ssize_t done = write ? pwritev(fd, iov, (int)n_iov, 0) : preadv(fd, iov, (int)n_iov, 0);
+        if (done != (ssize_t)file_size) {
+            report_error(write ? "Failed to write data" : "Failed to read data");
+            close(fd);
+            free(iov);
+            return -1;
+        }
+        if (finish_small_file(fd, write, sync_files) != 0) {
+            free(iov);
+            return -1;
+        }
+        timeline_add(IO.timeline, file_size);
+    }
+    free(iov);
+    return 0;
+}
+
+#ifdef MPI_TEST_UTILS_HAVE_IO_URING
+// Submit everything queued and wait for `n_expected` completions. Results are stored by user_data.
+static int uring_run_batch(uring_t* ring, unsigned n_expected, int32_t* results)
+{
+    if (uring_submit_and_wait(ring, n_expected) < 0) {
+        report_error("Failed to submit io_uring batch");
+        return -1;
+    }
+    unsigned n_done = 0;
+    while (n_done < n_expected) {
+        uint64_t user_data;
+        int32_t res;
+        if (uring_pop_cqe(ring, &user_data, &res)) {
+            results[user_data] = res;
+            n_done++;
+        } else if (uring_submit_and_wait(ring, n_expected - n_done) < 0) {
+            report_error("Failed to wait for io_uring completions");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Files are processed in batches: one submission opens the whole batch,
+// a second one issues linked read/write -> (fsync) -> close chains for every file.
+static int small_files_io_uring(
+    const char* dir, char* buffer, size_t file_size, size_t n_files, bool write, bool sync_files)
+{
+    uring_t ring;
+    if (uring_init(&ring, SMALL_FILE_BATCH * 4) != 0) {
+        report_error("Failed to set up io_uring");
+        return -1;
+    }
+    char(*paths)[SMALL_FILE_PATH_LEN] = calloc(SMALL_FILE_BATCH, SMALL_FILE_PATH_LEN);
+    int32_t* results = calloc(SMALL_FILE_BATCH * 3, sizeof(int32_t));
+    if (paths == NULL || results == NULL) {
+        report_error("Failed to allocate io_uring batch");
+        free(paths);
+        free(results);
+        uring_exit(&ring);
+        return -1;
+    }
+    int status = 0;
+    for (size_t first = 0; first < n_files && status == 0; first += SMALL_FILE_BATCH) {
+        size_t n_batch = n_files - first < SMALL_FILE_BATCH ? n_files - first : SMALL_FILE_BATCH;
+        for (size_t j = 0; j < n_batch; j++) {
+            small_file_path(paths[j], dir, first + j);
+            struct io_uring_sqe* sqe = uring_get_sqe(&ring);
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = (uint64_t)(uintptr_t)paths[j];
+            sqe->open_flags = write ? O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC : O_RDONLY | O_CLOEXEC;
+            sqe->len = S_IRUSR | S_IWUSR;
+            sqe->user_data = j;
+        }
+        if (uring_run_batch(&ring, (unsigned)n_batch, results) != 0) {
+            status = -1;
+            break;
+        }
+        int fds[SMALL_FILE_BATCH];
+        for (size_t j = 0; j < n_batch; j++) {
+            fds[j] = results[j];
+            if (fds[j] < 0) {
+                fprintf(stderr, "Failed to open %s: %s\n", paths[j], strerror(-fds[j]));
+                status = -1;
+            }
+        }
+        if (status != 0) {
+            for (size_t j = 0; j < n_batch; j++) {
+                if (fds[j] >= 0) {
+                    close(fds[j]);
+                }
+            }
+            break;
+        }
+
+        unsigned n_sqes = 0;
+        for (size_t j = 0; j < n_batch; j++) {
+            struct io_uring_sqe* sqe = uring_get_sqe(&ring);
+            sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe->flags = IOSQE_IO_LINK;
+            sqe->fd = fds[j];
+            sqe->addr = (uint64_t)(uintptr_t)buffer;
+            sqe->len = (uint32_t)file_size;
+            sqe->user_data = j * 3;
+            if (write && sync_files) {
+                sqe = uring_get_sqe(&ring);
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->flags = IOSQE_IO_LINK;
+                sqe->fd = fds[j];
+                sqe->user_data = j * 3 + 1;
+                n_sqes++;
+            } else {
+                results[j * 3 + 1] = 0;
+            }
+            sqe = uring_get_sqe(&ring);
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd = fds[j];
+            sqe->user_data = j * 3 + 2;
+            n_sqes += 2;
+        }
+        if (uring_run_batch(&ring, n_sqes, results) != 0) {
+            status = -1;
+            break;
+        }
+        for (size_t j = 0; j < n_batch; j++) {
+            if (results[j * 3] != (int32_t)file_size || results[j * 3 + 1] != 0) {
+                fprintf(stderr, "Failed to %s %s: %s\n", write ? "write" : "read", paths[j],
+                    results[j * 3] < 0 ? strerror(-results[j * 3]) : "short transfer or sync failure");
+                status = -1;
+            }
+            if (results[j * 3 + 2] != 0) {
+                // The close was cancelled by a failed link, so close it here.
+                close(fds[j]);
+            }
+        }
+        timeline_add(IO.timeline, (uint64_t)n_batch * file_size);
+    }
+    free(results);
+    free(paths);
+    uring_exit(&ring);
+    return status;
+}
+#else
+static int small_files_io_uring(
+    const char* dir, char* buffer, size_t file_size, size_t n_files, bool write, bool sync_files)
+{
+    (void)dir;
+    (void)buffer;
+    (void)file_size;
+    (void)n_files;
+    (void)write;
+    (void)sync_files;
+    fprintf(stderr, "io_uring is not available in this build\n");
+    return -1;
+}
+#endif
+
+static ssize_t test_small_files(
+    const char* dir, size_t file_size, size_t n_files, small_file_variant_t variant, bool write, bool sync_files)
+{
+    char* buffer = io_buffer(file_size);
+    if (buffer == NULL) {
+        return -1;
+    }
+    timed_region_t region;
+    timed_region_begin(&region);
+    int status = -1;
+    switch (variant) {
+    case SMALL_FILE_SYSCALL:
+        status = small_files_syscall(dir, buffer, file_size, n_files, write, sync_files);
+        break;
+    case SMALL_FILE_VECTORED:
+        status = small_files_vectored(dir, buffer, file_size, n_files, write, sync_files);
+        break;
+    case SMALL_FILE_IO_URING:
+        status = small_files_io_uring(dir, buffer, file_size, n_files, write, sync_files);
+        break;
+    }
+    if (status != 0) {
+        timed_region_cancel(&region);
+        return -1;
+    }
+    return timed_region_end(&region);
+}
+
+ssize_t test_small_file_write_nompi(
+    const char* dir, size_t file_size, size_t n_files, small_file_variant_t variant, bool sync_files)
+{
+    return test_small_files(dir, file_size, n_files, variant, true, sync_files);
+}
+
+ssize_t test_small_file_read_nompi(const char* dir, size_t file_size, size_t n_files, small_file_variant_t variant)
+{
+    return test_small_files(dir, file_size, n_files, variant, false, false);
 }
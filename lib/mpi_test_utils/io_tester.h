@@ -7,11 +7,150 @@
 // Enable POSIX extensions
 #define _POSIX_C_SOURCE 200809L // NOLINT
 
+#include "mpi_test_utils/perf_counters.h"
+
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Defined in timeline.h, which relies on C11 atomics and is therefore not included here.
+typedef struct timeline timeline_t;
+
+/*!
+ * @brief Enable hardware/OS counter collection around the timed region of every test.
+ *
+ * Disabled by default. Counters of the most recent test are available from #io_tester_last_perf.
+ */
+void io_tester_set_perf(bool enable);
+const perf_sample_t* io_tester_last_perf(void);
+
+/*!
+ * @brief Record bandwidth over time of every test into `timeline`. Pass NULL to disable.
+ *
+ * The timeline is restarted at the beginning of each timed region and stopped at its end.
+ */
+void io_tester_set_timeline(timeline_t* timeline);
+
+/*!
+ * @brief Keep the buffering that the libc chooses for a stream, usually `st_blksize` bytes.
+ */
+#define IO_STDIO_BUFFER_DEFAULT SIZE_MAX
+
+/*!
+ * @brief Buffer size of the streams of #test_sequential_write_nompi, #test_sequential_read_nompi and
+ * #test_random_read_nompi, applied with setvbuf. 0 makes them unbuffered.
+ *
+ * #IO_STDIO_BUFFER_DEFAULT by default. The buffer comes from the shared pool and is mapped before the timed region.
+ */
+void io_tester_set_stdio_buffer(size_t size);
+
 ssize_t test_sequential_write_nompi(const char* file_name, size_t block_size, size_t n_blocks);
 ssize_t test_sequential_read_nompi(const char* file_name, size_t block_size, size_t n_blocks);
 ssize_t test_random_read_nompi(const char* file_name, size_t block_size, size_t n_blocks, size_t n_reads);
 ssize_t test_sequential_write_libaio(const char* file_name, size_t block_size, size_t n_blocks);
+
+/*!
+ * @brief Same access pattern as #test_sequential_read_nompi through read(2), without stdio.
+ * @return Elapsed time in nanoseconds, or -1 on failure.
+ */
+ssize_t test_sequential_read_syscall_nompi(const char* file_name, size_t block_size, size_t n_blocks);
+/*!
+ * @brief Same access pattern as #test_random_read_nompi through pread(2), without stdio.
+ * @return Elapsed time in nanoseconds, or -1 on failure.
+ */
+ssize_t test_random_read_syscall_nompi(const char* file_name, size_t block_size, size_t n_blocks, size_t n_reads);
+
+typedef enum {
+    /*!
+     * @brief Data may stay in the page cache, as in #test_sequential_write_nompi.
+     */
+    SYNC_NONE,
+    /*!
+     * @brief fsync once after the last block.
+     */
+    SYNC_FSYNC_END,
+    /*!
+     * @brief fdatasync every `sync_interval` blocks and after the last block.
+     */
+    SYNC_FDATASYNC_EVERY_N,
+    /*!
+     * @brief Open with O_DSYNC so that every write is durable on return.
+     */
+    SYNC_O_DSYNC,
+    /*!
+     * @brief Start writeback of each `sync_interval`-block window with sync_file_range
+     * while waiting for the previous window, then fdatasync after the last block.
+     */
+    SYNC_FILE_RANGE
+} sync_policy_t;
+
+const char* sync_policy_name(sync_policy_t policy);
+
+/*!
+ * @brief Sequential write through write(2) with a durability policy.
+ *
+ * Unlike #test_sequential_write_nompi, all synchronization required by the policy happens inside the timed region.
+ * @return Elapsed time in nanoseconds, or -1 on failure.
+ */
+ssize_t test_sequential_write_sync_nompi(
+    const char* file_name, size_t block_size, size_t n_blocks, sync_policy_t policy, size_t sync_interval);
+
+/*!
+ * @brief Same as #test_sequential_write_sync_nompi through fwrite(3) with the stream buffer of
+ * #io_tester_set_stdio_buffer. The stream is flushed before each sync, so every synced interval is complete.
+ * With #SYNC_NONE this is #test_sequential_write_nompi.
+ * @return Elapsed time in nanoseconds, or -1 on failure.
+ */
+ssize_t test_sequential_write_stdio_sync_nompi(
+    const char* file_name, size_t block_size, size_t n_blocks, sync_policy_t policy, size_t sync_interval);
+
+typedef enum {
+    /*!
+     * @brief open, one read/write per block, close.
+     */
+    SMALL_FILE_SYSCALL,
+    /*!
+     * @brief open, a single preadv/pwritev per file, close.
+     */
+    SMALL_FILE_VECTORED,
+    /*!
+     * @brief Batched io_uring submissions of open and linked read/write, fsync and close. Requires Linux 5.6.
+     */
+    SMALL_FILE_IO_URING
+} small_file_variant_t;
+
+const char* small_file_variant_name(small_file_variant_t variant);
+
+/*!
+ * @brief Whether `variant` can run here. #SMALL_FILE_IO_URING is unavailable if the library was built without it,
+ * or if the kernel lacks io_uring or refuses it (seccomp, `kernel.io_uring_disabled`).
+ */
+bool small_file_variant_available(small_file_variant_t variant);
+
+/*!
+ * @brief Remove files written by #test_small_file_write_nompi.
+ */
+void small_file_remove(const char* dir, size_t n_files);
+
+/*!
+ * @brief Create `n_files` files `<dir>/small.<i>` of `file_size` bytes each, optionally fsync-ing each one.
+ * @return Elapsed time in nanoseconds, or -1 on failure.
+ */
+ssize_t test_small_file_write_nompi(
+    const char* dir, size_t file_size, size_t n_files, small_file_variant_t variant, bool sync_files);
+/*!
+ * @brief Read back files written by #test_small_file_write_nompi.
+ * @return Elapsed time in nanoseconds, or -1 on failure.
+ */
+ssize_t test_small_file_read_nompi(const char* dir, size_t file_size, size_t n_files, small_file_variant_t variant);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // MPI_TEST_UTILS_IO_TESTER_H
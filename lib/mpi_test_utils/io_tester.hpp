@@ -0,0 +1,486 @@
+#ifndef MPI_TEST_UTILS_IO_TESTER_HPP
+#define MPI_TEST_UTILS_IO_TESTER_HPP
+
+#include "mpi_test_utils/buffer_pool.h"
+#include "mpi_test_utils/fmt.h"
+#include "mpi_test_utils/io_tester.h"
+#include "mpi_test_utils/log.h"
+#include "mpi_test_utils/perf_counters.h"
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+/*!
+ * @file io_tester.hpp
+ * @brief Header-only C++17 layer over io_tester.h, fmt.h and log.h, for applications that run the tests
+ * themselves, e.g. to pick an I/O strategy at startup.
+ *
+ * Failures are reported as #mpi_test_utils::io_error instead of -1 and `perror`, durations as `std::chrono`
+ * types, and files and buffers are owned by RAII handles. The C API is unchanged.
+ */
+
+namespace mpi_test_utils {
+
+/*!
+ * @brief Failure of a test or a handle. `code()` holds the errno of the failing call.
+ */
+class io_error : public std::system_error {
+public:
+    using std::system_error::system_error;
+};
+
+namespace detail {
+
+    // Callers pass `errno` saved before building `what`, whose allocation may overwrite it.
+    [[noreturn]] inline void throw_errno(int err, const std::string& what)
+    {
+        throw io_error(std::error_code(err != 0 ? err : EIO, std::generic_category()), what);
+    }
+
+    // Takes ownership of a string allocated by fmt.h.
+    inline std::string take_string(char* str)
+    {
+        std::unique_ptr<char, decltype(&std::free)> owner(str, &std::free);
+        if (str == nullptr) {
+            throw std::bad_alloc();
+        }
+        return std::string(str);
+    }
+
+} // namespace detail
+
+/*!
+ * @brief Owning file descriptor, closed on destruction.
+ */
+class file {
+public:
+    file() = default;
+    /*!
+     * @brief Open `path` with `flags` of open(2). O_CLOEXEC is always added.
+     */
+    file(const std::string& path, int flags, mode_t mode = 0644)
+        : fd_(::open(path.c_str(), flags | O_CLOEXEC, mode))
+    {
+        if (fd_ < 0) {
+            int err = errno;
+            detail::throw_errno(err, "Failed to open " + path);
+        }
+    }
+    file(const file&) = delete;
+    file& operator=(const file&) = delete;
+    file(file&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1))
+    {
+    }
+    file& operator=(file&& other) noexcept
+    {
+        if (this != &other) {
+            close();
+            fd_ = std::exchange(other.fd_, -1);
+        }
+        return *this;
+    }
+    ~file() { close(); }
+
+    int fd() const noexcept { return fd_; }
+    explicit operator bool() const noexcept { return fd_ >= 0; }
+
+    void sync() const
+    {
+        if (::fdatasync(fd_) != 0) {
+            int err = errno;
+            detail::throw_errno(err, "Failed to sync file");
+        }
+    }
+
+    void close() noexcept
+    {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+private:
+    int fd_ = -1;
+};
+
+/*!
+ * @brief Owning page-aligned, prefaulted buffer from #buffer_alloc, suitable for O_DIRECT.
+ */
+class buffer {
+public:
+    /*!
+     * @param flags Bitwise OR of #buffer_flags_t.
+     */
+    explicit buffer(std::size_t size, int flags = 0)
+    {
+        if (buffer_alloc(&buffer_, size, flags) != 0) {
+            int err = errno;
+            detail::throw_errno(err, "Failed to allocate buffer");
+        }
+    }
+    buffer(const buffer&) = delete;
+    buffer& operator=(const buffer&) = delete;
+    buffer(buffer&& other) noexcept
+        : buffer_(std::exchange(other.buffer_, buffer_t {}))
+    {
+    }
+    buffer& operator=(buffer&& other) noexcept
+    {
+        if (this != &other) {
+            buffer_release(&buffer_);
+            buffer_ = std::exchange(other.buffer_, buffer_t {});
+        }
+        return *this;
+    }
+    ~buffer() { buffer_release(&buffer_); }
+
+    char* data() noexcept { return static_cast<char*>(buffer_.data); }
+    const char* data() const noexcept { return static_cast<const char*>(buffer_.data); }
+    std::size_t size() const noexcept { return buffer_.size; }
+    bool huge_pages() const noexcept { return buffer_.huge_pages; }
+    bool locked() const noexcept { return buffer_.locked; }
+
+private:
+    buffer_t buffer_ {};
+};
+
+/*!
+ * @brief Bytes moved in a timed region.
+ */
+struct io_result {
+    std::chrono::nanoseconds elapsed {};
+    std::uint64_t bytes = 0;
+
+    /*!
+     * @brief Bandwidth in MB/s, as printed by the C executables.
+     */
+    double mb_per_s() const noexcept
+    {
+        return elapsed.count() > 0 ? static_cast<double>(bytes) / static_cast<double>(elapsed.count()) * 1e3 : 0.0;
+    }
+};
+
+// Engine policies: how one block is transferred and which flags the file is opened with.
+
+struct pread_engine {
+    static constexpr const char* name = "pread/pwrite";
+    static constexpr int open_flags = 0;
+    static ssize_t read(int fd, char* data, std::size_t len, off_t offset) noexcept
+    {
+        return ::pread(fd, data, len, offset);
+    }
+    static ssize_t write(int fd, const char* data, std::size_t len, off_t offset) noexcept
+    {
+        return ::pwrite(fd, data, len, offset);
+    }
+};
+
+/*!
+ * @brief Bypass the page cache. Block size and offsets must be multiples of the logical block size.
+ */
+struct direct_engine : pread_engine {
+    static constexpr const char* name = "O_DIRECT";
+    static constexpr int open_flags = O_DIRECT;
+};
+
+/*!
+ * @brief Every write is durable on return, as #SYNC_O_DSYNC.
+ */
+struct dsync_engine : pread_engine {
+    static constexpr const char* name = "O_DSYNC";
+    static constexpr int open_flags = O_DSYNC;
+};
+
+// Pattern policies: the block index of each transfer, constructed from the number of blocks in the file and a seed.
+
+struct sequential_pattern {
+    static constexpr const char* name = "sequential";
+    sequential_pattern(std::size_t n_blocks, std::uint64_t /* seed */) noexcept
+        : n_blocks_(n_blocks)
+    {
+    }
+    /*!
+     * @brief Wraps around after the last block.
+     */
+    std::size_t next() noexcept
+    {
+        std::size_t block = next_;
+        next_ = next_ + 1 == n_blocks_ ? 0 : next_ + 1;
+        return block;
+    }
+
+private:
+    std::size_t n_blocks_;
+    std::size_t next_ = 0;
+};
+
+struct random_pattern {
+    static constexpr const char* name = "random";
+    random_pattern(std::size_t n_blocks, std::uint64_t seed)
+        : rng_(seed)
+        , dist_(0, n_blocks - 1)
+    {
+    }
+    std::size_t next() { return dist_(rng_); }
+
+private:
+    std::mt19937_64 rng_;
+    std::uniform_int_distribution<std::size_t> dist_;
+};
+
+enum class access { read, write };
+
+struct io_config {
+    std::string path;
+    std::size_t block_size = 1 << 20;
+    /*!
+     * @brief Blocks in the file. Writes create it; reads expect it to exist.
+     */
+    std::size_t n_blocks = 1024;
+    /*!
+     * @brief Blocks transferred, `n_blocks` if 0.
+     */
+    std::size_t n_ops = 0;
+    std::uint64_t seed = 42;
+    /*!
+     * @brief fdatasync after the last write, inside the timed region.
+     */
+    bool sync = false;
+};
+
+/*!
+ * @brief Time `n_ops` block transfers of `Access` through `Engine` at offsets from `Pattern`.
+ *
+ * The loop is instantiated per policy combination, so transfers and offsets are resolved at compile time.
+ * `buf` must hold at least one block. Writes are synced at the end only with `config.sync`, or by the engine.
+ * @throws io_error on invalid configuration or failed transfer.
+ */
+template <access Access, class Engine = pread_engine, class Pattern = sequential_pattern>
+io_result run(const io_config& config, buffer& buf)
+{
+    if (config.block_size == 0 || config.n_blocks == 0 || buf.size() < config.block_size) {
+        throw io_error(std::make_error_code(std::errc::invalid_argument), "Invalid block size or count");
+    }
+    constexpr int flags = (Access == access::write ? O_WRONLY | O_CREAT | O_TRUNC : O_RDONLY) | Engine::open_flags;
+    file f(config.path, flags);
+    Pattern pattern(config.n_blocks, config.seed);
+    const std::size_t n_ops = config.n_ops == 0 ? config.n_blocks : config.n_ops;
+    char* data = buf.data();
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < n_ops; i++) {
+        off_t offset = static_cast<off_t>(pattern.next() * config.block_size);
+        std::size_t done = 0;
+        while (done < config.block_size) {
+            ssize_t n;
+            if constexpr (Access == access::write) {
+                n = Engine::write(f.fd(), data + done, config.block_size - done, offset + static_cast<off_t>(done));
+            } else {
+                n = Engine::read(f.fd(), data + done, config.block_size - done, offset + static_cast<off_t>(done));
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                int err = errno;
+                detail::throw_errno(err, Access == access::write ? "Failed to write data" : "Failed to read data");
+            }
+            if (n == 0) {
+                throw io_error(std::make_error_code(std::errc::io_error), "Unexpected end of " + config.path);
+            }
+            done += static_cast<std::size_t>(n);
+        }
+    }
+    if constexpr (Access == access::write) {
+        if (config.sync) {
+            f.sync();
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return { std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed),
+        static_cast<std::uint64_t>(n_ops) * config.block_size };
+}
+
+// Wrappers of the C tests. These share the library's buffer pool, counters and timeline.
+
+namespace detail {
+
+    inline io_result checked(ssize_t elapsed_ns, std::uint64_t bytes, const char* what)
+    {
+        if (elapsed_ns < 0) {
+            int err = errno;
+            // Not every failure of the C tests sets errno, e.g. a short write.
+            if (err == 0) {
+                throw io_error(std::make_error_code(std::errc::io_error), what);
+            }
+            throw_errno(err, what);
+        }
+        return { std::chrono::nanoseconds(elapsed_ns), bytes };
+    }
+
+} // namespace detail
+
+inline io_result sequential_write(const std::string& path, std::size_t block_size, std::size_t n_blocks)
+{
+    errno = 0;
+    return detail::checked(test_sequential_write_nompi(path.c_str(), block_size, n_blocks),
+        static_cast<std::uint64_t>(block_size) * n_blocks, "Sequential write failed");
+}
+
+inline io_result sequential_read(const std::string& path, std::size_t block_size, std::size_t n_blocks)
+{
+    errno = 0;
+    return detail::checked(test_sequential_read_nompi(path.c_str(), block_size, n_blocks),
+        static_cast<std::uint64_t>(block_size) * n_blocks, "Sequential read failed");
+}
+
+inline io_result random_read(const std::string& path, std::size_t block_size, std::size_t n_blocks, std::size_t n_reads)
+{
+    errno = 0;
+    return detail::checked(test_random_read_nompi(path.c_str(), block_size, n_blocks, n_reads),
+        static_cast<std::uint64_t>(block_size) * n_reads, "Random read failed");
+}
+
+inline io_result sequential_read_syscall(const std::string& path, std::size_t block_size, std::size_t n_blocks)
+{
+    errno = 0;
+    return detail::checked(test_sequential_read_syscall_nompi(path.c_str(), block_size, n_blocks),
+        static_cast<std::uint64_t>(block_size) * n_blocks, "Sequential read failed");
+}
+
+inline io_result random_read_syscall(
+    const std::string& path, std::size_t block_size, std::size_t n_blocks, std::size_t n_reads)
+{
+    errno = 0;
+    return detail::checked(test_random_read_syscall_nompi(path.c_str(), block_size, n_blocks, n_reads),
+        static_cast<std::uint64_t>(block_size) * n_reads, "Random read failed");
+}
+
+inline io_result sequential_write_libaio(const std::string& path, std::size_t block_size, std::size_t n_blocks)
+{
+    errno = 0;
+    return detail::checked(test_sequential_write_libaio(path.c_str(), block_size, n_blocks),
+        static_cast<std::uint64_t>(block_size) * n_blocks, "Asynchronous write failed");
+}
+
+inline io_result sequential_write_sync(const std::string& path, std::size_t block_size, std::size_t n_blocks,
+    sync_policy_t policy, std::size_t sync_interval = 1)
+{
+    errno = 0;
+    return detail::checked(test_sequential_write_sync_nompi(path.c_str(), block_size, n_blocks, policy, sync_interval),
+        static_cast<std::uint64_t>(block_size) * n_blocks, "Synchronized write failed");
+}
+
+inline io_result sequential_write_stdio_sync(const std::string& path, std::size_t block_size, std::size_t n_blocks,
+    sync_policy_t policy, std::size_t sync_interval = 1)
+{
+    errno = 0;
+    return detail::checked(
+        test_sequential_write_stdio_sync_nompi(path.c_str(), block_size, n_blocks, policy, sync_interval),
+        static_cast<std::uint64_t>(block_size) * n_blocks, "Synchronized stdio write failed");
+}
+
+inline io_result small_file_write(const std::string& dir, std::size_t file_size, std::size_t n_files,
+    small_file_variant_t variant = SMALL_FILE_SYSCALL, bool sync_files = false)
+{
+    errno = 0;
+    return detail::checked(test_small_file_write_nompi(dir.c_str(), file_size, n_files, variant, sync_files),
+        static_cast<std::uint64_t>(file_size) * n_files, "Small file write failed");
+}
+
+inline io_result small_file_read(const std::string& dir, std::size_t file_size, std::size_t n_files,
+    small_file_variant_t variant = SMALL_FILE_SYSCALL)
+{
+    errno = 0;
+    return detail::checked(test_small_file_read_nompi(dir.c_str(), file_size, n_files, variant),
+        static_cast<std::uint64_t>(file_size) * n_files, "Small file read failed");
+}
+
+/*!
+ * @brief Counters of the most recent C test, if enabled with #io_tester_set_perf.
+ */
+inline perf_sample_t last_perf() { return *io_tester_last_perf(); }
+
+// fmt.h
+
+template <class Int> std::string format_si(Int value, int precision = 2)
+{
+    static_assert(std::is_integral_v<Int>, "format_si requires an integer");
+    if constexpr (std::is_signed_v<Int>) {
+        return detail::take_string(format_with_si_64(static_cast<std::int64_t>(value), precision));
+    } else {
+        return detail::take_string(format_with_si_u64(static_cast<std::uint64_t>(value), precision));
+    }
+}
+
+template <class Int> std::string format_comma(Int value)
+{
+    static_assert(std::is_integral_v<Int>, "format_comma requires an integer");
+    if constexpr (std::is_signed_v<Int>) {
+        return detail::take_string(format_with_comma_64(static_cast<std::int64_t>(value)));
+    } else {
+        return detail::take_string(format_with_comma_u64(static_cast<std::uint64_t>(value)));
+    }
+}
+
+// log.h. The call site is filled in by the compiler, as __FILE__ and __LINE__ are by the C macros.
+
+namespace logging {
+
+    inline void write(int level, const std::string& message, const char* file = __builtin_FILE(),
+        int line = __builtin_LINE())
+    {
+        log_log(level, file, line, "%s", message.c_str());
+    }
+
+    inline void trace(const std::string& message, const char* file = __builtin_FILE(), int line = __builtin_LINE())
+    {
+        write(LOG_TRACE, message, file, line);
+    }
+
+    inline void debug(const std::string& message, const char* file = __builtin_FILE(), int line = __builtin_LINE())
+    {
+        write(LOG_DEBUG, message, file, line);
+    }
+
+    inline void info(const std::string& message, const char* file = __builtin_FILE(), int line = __builtin_LINE())
+    {
+        write(LOG_INFO, message, file, line);
+    }
+
+    inline void warn(const std::string& message, const char* file = __builtin_FILE(), int line = __builtin_LINE())
+    {
+        write(LOG_WARN, message, file, line);
+    }
+
+    inline void error(const std::string& message, const char* file = __builtin_FILE(), int line = __builtin_LINE())
+    {
+        write(LOG_ERROR, message, file, line);
+    }
+
+    inline void fatal(const std::string& message, const char* file = __builtin_FILE(), int line = __builtin_LINE())
+    {
+        write(LOG_FATAL, message, file, line);
+    }
+
+} // namespace logging
+
+} // namespace mpi_test_utils
+
+#endif // MPI_TEST_UTILS_IO_TESTER_HPP
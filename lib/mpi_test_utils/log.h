@@ -41,6 +41,10 @@
 #include <stdio.h>
 #include <time.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /*!
  * @def LOG_USE_COLOR
  * @brief If the library is compiled with `-DLOG_USE_COLOR` ANSI color escape
@@ -192,4 +196,8 @@ int log_add_fp(FILE* fp, int level);
 
 void log_log(int level, const char* file, int line, const char* fmt, ...);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,131 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/md_tester.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MD_PATH_LEN 4096
+
+static const char* md_phase_names[] = { "create", "stat", "open_close", "readdir", "unlink" };
+
+const char* md_phase_name(md_phase_t phase) { return md_phase_names[phase]; }
+
+static double diff_ns(const struct timespec* start, const struct timespec* end)
+{
+    return (double)((end->tv_sec - start->tv_sec) * 1000000000 + (end->tv_nsec - start->tv_nsec));
+}
+
+static int md_op(md_phase_t phase, const char* path)
+{
+    switch (phase) {
+    case MD_CREATE: {
+        int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if (fd == -1) {
+            perror("Failed to create file");
+            return -1;
+        }
+        close(fd);
+        return 0;
+    }
+    case MD_STAT: {
+        struct stat st;
+        if (stat(path, &st) != 0) {
+            perror("Failed to stat file");
+            return -1;
+        }
+        return 0;
+    }
+    case MD_OPEN_CLOSE: {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            perror("Failed to open file");
+            return -1;
+        }
+        close(fd);
+        return 0;
+    }
+    case MD_UNLINK:
+        if (unlink(path) != 0) {
+            perror("Failed to unlink file");
+            return -1;
+        }
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+static ssize_t test_readdir(const char* dir, size_t max_latencies, double* latencies_ns, size_t* n_ops)
+{
+    struct timespec start, end, op_start, op_end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    DIR* dirp = opendir(dir);
+    if (dirp == NULL) {
+        perror("Failed to open directory");
+        return -1;
+    }
+    *n_ops = 0;
+    while (1) {
+        clock_gettime(CLOCK_MONOTONIC, &op_start);
+        struct dirent* entry = readdir(dirp);
+        clock_gettime(CLOCK_MONOTONIC, &op_end);
+        if (entry == NULL) {
+            break;
+        }
+        if (latencies_ns != NULL && *n_ops < max_latencies) {
+            latencies_ns[*n_ops] = diff_ns(&op_start, &op_end);
+        }
+        (*n_ops)++;
+    }
+    closedir(dirp);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (ssize_t)diff_ns(&start, &end);
+}
+
+ssize_t test_metadata_nompi(
+    md_phase_t phase, const char* dir, const char* prefix, size_t n_files, double* latencies_ns, size_t* n_ops)
+{
+    if (phase == MD_READDIR) {
+        return test_readdir(dir, n_files, latencies_ns, n_ops);
+    }
+    char path[MD_PATH_LEN];
+    struct timespec start, end, op_start, op_end;
+    *n_ops = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < n_files; i++) {
+        snprintf(path, MD_PATH_LEN, "%s/%s.%zu", dir, prefix, i);
+        clock_gettime(CLOCK_MONOTONIC, &op_start);
+        if (md_op(phase, path) != 0) {
+            return -1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &op_end);
+        if (latencies_ns != NULL) {
+            latencies_ns[i] = diff_ns(&op_start, &op_end);
+        }
+        (*n_ops)++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (ssize_t)diff_ns(&start, &end);
+}
+
+int md_remove_files(const char* dir, const char* prefix, size_t n_files)
+{
+    char path[MD_PATH_LEN];
+    int status = 0;
+    for (size_t i = 0; i < n_files; i++) {
+        snprintf(path, MD_PATH_LEN, "%s/%s.%zu", dir, prefix, i);
+        if (unlink(path) != 0 && errno != ENOENT) {
+            perror("Failed to unlink file");
+            status = -1;
+        }
+    }
+    return status;
+}
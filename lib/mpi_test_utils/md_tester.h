@@ -0,0 +1,45 @@
+#ifndef MPI_TEST_UTILS_MD_TESTER_H
+#define MPI_TEST_UTILS_MD_TESTER_H
+
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { MD_CREATE, MD_STAT, MD_OPEN_CLOSE, MD_READDIR, MD_UNLINK, MD_N_PHASES } md_phase_t;
+
+const char* md_phase_name(md_phase_t phase);
+
+/*!
+ * @brief Run one metadata phase over files `<dir>/<prefix>.<i>` for i in [0, n_files).
+ *
+ * #MD_CREATE creates empty files, #MD_STAT stats them, #MD_OPEN_CLOSE opens and closes them read-only,
+ * #MD_UNLINK removes them. #MD_READDIR lists the whole of `dir`, so in a shared directory it also sees
+ * files of other ranks.
+ *
+ * @param latencies_ns Receives the latency of each operation, at most `n_files` entries. May be NULL.
+ * @param n_ops Receives the number of operations performed.
+ * @return Elapsed time in nanoseconds, or -1 on failure.
+ */
+ssize_t test_metadata_nompi(
+    md_phase_t phase, const char* dir, const char* prefix, size_t n_files, double* latencies_ns, size_t* n_ops);
+
+/*!
+ * @brief Remove whatever files `<dir>/<prefix>.<i>` for i in [0, n_files) exist, e.g. after a failed phase.
+ *
+ * Unlike #MD_UNLINK, missing files are skipped and removal continues past errors.
+ *
+ * @return 0 if every file is gone, or -1 if any could not be removed.
+ */
+int md_remove_files(const char* dir, const char* prefix, size_t n_files);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_MD_TESTER_H
@@ -0,0 +1,303 @@
+// MAP_ANONYMOUS is not part of POSIX
+#define _GNU_SOURCE // NOLINT
+
+#include "mpi_test_utils/mem_tester.h"
+#include "mpi_test_utils/topology.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// Eight doubles per vector; the compiler lowers this to whatever SIMD width the target supports.
+typedef double vec_t __attribute__((vector_size(64)));
+
+#define VEC_LANES (sizeof(vec_t) / sizeof(double))
+#define STREAM_SCALAR 3.0
+
+// Threads wait here until all of them have been created, or learn that some could not be and leave.
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool open;
+    bool cancelled;
+} start_gate_t;
+
+typedef struct {
+    const stream_config_t* config;
+    size_t index;
+    start_gate_t* gate;
+    pthread_barrier_t* barrier;
+    double* a;
+    double* b;
+    double* c;
+    size_t array_len;
+    int status;
+    // Written by thread 0 only.
+    double best_ns[STREAM_N_KERNELS];
+    // Time of this thread's own kernel, without waiting for the others.
+    double own_best_ns[STREAM_N_KERNELS];
+} stream_thread_t;
+
+static const char* stream_kernel_names[] = { "copy", "scale", "add", "triad" };
+
+const char* stream_kernel_name(stream_kernel_t kernel) { return stream_kernel_names[kernel]; }
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void kernel_copy(double* restrict c, const double* restrict a, size_t n)
+{
+    size_t nv = n / VEC_LANES;
+    vec_t* vc = (vec_t*)c;
+    const vec_t* va = (const vec_t*)a;
+    for (size_t i = 0; i < nv; i++) {
+        vc[i] = va[i];
+    }
+    for (size_t i = nv * VEC_LANES; i < n; i++) {
+        c[i] = a[i];
+    }
+}
+
+static void kernel_scale(double* restrict b, const double* restrict c, size_t n)
+{
+    size_t nv = n / VEC_LANES;
+    vec_t* vb = (vec_t*)b;
+    const vec_t* vc = (const vec_t*)c;
+    for (size_t i = 0; i < nv; i++) {
+        vb[i] = STREAM_SCALAR * vc[i];
+    }
+    for (size_t i = nv * VEC_LANES; i < n; i++) {
+        b[i] = STREAM_SCALAR * c[i];
+    }
+}
+
+static void kernel_add(double* restrict c, const double* restrict a, const double* restrict b, size_t n)
+{
+    size_t nv = n / VEC_LANES;
+    vec_t* vc = (vec_t*)c;
+    const vec_t* va = (const vec_t*)a;
+    const vec_t* vb = (const vec_t*)b;
+    for (size_t i = 0; i < nv; i++) {
+        vc[i] = va[i] + vb[i];
+    }
+    for (size_t i = nv * VEC_LANES; i < n; i++) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+static void kernel_triad(double* restrict a, const double* restrict b, const double* restrict c, size_t n)
+{
+    size_t nv = n / VEC_LANES;
+    vec_t* va = (vec_t*)a;
+    const vec_t* vb = (const vec_t*)b;
+    const vec_t* vc = (const vec_t*)c;
+    for (size_t i = 0; i < nv; i++) {
+        va[i] = vb[i] + STREAM_SCALAR * vc[i];
+    }
+    for (size_t i = nv * VEC_LANES; i < n; i++) {
+        a[i] = b[i] + STREAM_SCALAR * c[i];
+    }
+}
+
+static void run_kernel(stream_thread_t* thread, stream_kernel_t kernel)
+{
+    size_t n = thread->config->n_elements;
+    switch (kernel) {
+    case STREAM_COPY:
+        kernel_copy(thread->c, thread->a, n);
+        break;
+    case STREAM_SCALE:
+        kernel_scale(thread->b, thread->c, n);
+        break;
+    case STREAM_ADD:
+        kernel_add(thread->c, thread->a, thread->b, n);
+        break;
+    case STREAM_TRIAD:
+        kernel_triad(thread->a, thread->b, thread->c, n);
+        break;
+    default:
+        break;
+    }
+}
+
+// Map an array of `len` bytes without touching it, so that the binding applies to every page.
+static double* alloc_array(size_t len, int numa_node)
+{
+    void* ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        perror("Failed to map STREAM array");
+        return NULL;
+    }
+    if (numa_node >= 0 && topology_bind_memory(ptr, len, numa_node) != 0) {
+        munmap(ptr, len);
+        return NULL;
+    }
+    return ptr;
+}
+
+static void free_array(double* array, size_t len)
+{
+    if (array != NULL) {
+        munmap(array, len);
+    }
+}
+
+static bool wait_for_start(start_gate_t* gate)
+{
+    pthread_mutex_lock(&gate->mutex);
+    while (!gate->open) {
+        pthread_cond_wait(&gate->cond, &gate->mutex);
+    }
+    bool cancelled = gate->cancelled;
+    pthread_mutex_unlock(&gate->mutex);
+    return !cancelled;
+}
+
+static void open_gate(start_gate_t* gate, bool cancelled)
+{
+    pthread_mutex_lock(&gate->mutex);
+    gate->open = true;
+    gate->cancelled = cancelled;
+    pthread_cond_broadcast(&gate->cond);
+    pthread_mutex_unlock(&gate->mutex);
+}
+
+static void* stream_thread_main(void* arg)
+{
+    stream_thread_t* thread = arg;
+    const stream_config_t* config = thread->config;
+    size_t n = config->n_elements;
+    if (!wait_for_start(thread->gate)) {
+        return NULL;
+    }
+    if (config->numa_node >= 0 && topology_bind_thread(config->numa_node) != 0) {
+        thread->status = -1;
+    }
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    thread->array_len = (n * sizeof(double) + page_size - 1) / page_size * page_size;
+    thread->array_len = thread->array_len == 0 ? page_size : thread->array_len;
+    if (thread->status == 0) {
+        thread->a = alloc_array(thread->array_len, config->numa_node);
+        thread->b = alloc_array(thread->array_len, config->numa_node);
+        thread->c = alloc_array(thread->array_len, config->numa_node);
+        if (thread->a == NULL || thread->b == NULL || thread->c == NULL) {
+            thread->status = -1;
+        }
+    }
+    if (thread->status == 0) {
+        // First touch from the bound thread.
+        for (size_t i = 0; i < n; i++) {
+            thread->a[i] = 1.0;
+            thread->b[i] = 2.0;
+            thread->c[i] = 0.0;
+        }
+    }
+    for (size_t k = 0; k < STREAM_N_KERNELS; k++) {
+        thread->best_ns[k] = -1.0;
+        thread->own_best_ns[k] = -1.0;
+    }
+    for (size_t iter = 0; iter < config->n_iterations; iter++) {
+        for (stream_kernel_t kernel = STREAM_COPY; kernel < STREAM_N_KERNELS; kernel++) {
+            pthread_barrier_wait(thread->barrier);
+            double start = now_ns();
+            if (thread->status == 0) {
+                run_kernel(thread, kernel);
+            }
+            double own = now_ns() - start;
+            pthread_barrier_wait(thread->barrier);
+            double elapsed = now_ns() - start;
+            // The first iteration warms up caches and TLBs.
+            if (iter == 0 && config->n_iterations > 1) {
+                continue;
+            }
+            if (thread->index == 0 && (thread->best_ns[kernel] < 0 || elapsed < thread->best_ns[kernel])) {
+                thread->best_ns[kernel] = elapsed;
+            }
+            if (thread->own_best_ns[kernel] < 0 || own < thread->own_best_ns[kernel]) {
+                thread->own_best_ns[kernel] = own;
+            }
+        }
+    }
+    free_array(thread->a, thread->array_len);
+    free_array(thread->b, thread->array_len);
+    free_array(thread->c, thread->array_len);
+    return NULL;
+}
+
+int test_stream_nompi(const stream_config_t* config, stream_result_t* result)
+{
+    memset(result, 0, sizeof(stream_result_t));
+    size_t n_threads = config->n_threads == 0 ? 1 : config->n_threads;
+    stream_thread_t* threads = calloc(n_threads, sizeof(stream_thread_t));
+    pthread_t* tids = calloc(n_threads, sizeof(pthread_t));
+    result->thread_best_mbps = calloc(n_threads * STREAM_N_KERNELS, sizeof(double));
+    if (threads == NULL || tids == NULL || result->thread_best_mbps == NULL) {
+        perror("Failed to allocate threads");
+        free(threads);
+        free(tids);
+        return -1;
+    }
+    result->n_threads = n_threads;
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned)n_threads);
+    start_gate_t gate = { .open = false, .cancelled = false };
+    pthread_mutex_init(&gate.mutex, NULL);
+    pthread_cond_init(&gate.cond, NULL);
+    int status = 0;
+    size_t n_started = 0;
+    for (size_t i = 0; i < n_threads; i++) {
+        threads[i].config = config;
+        threads[i].index = i;
+        threads[i].gate = &gate;
+        threads[i].barrier = &barrier;
+        if (pthread_create(&tids[i], NULL, stream_thread_main, &threads[i]) != 0) {
+            perror("Failed to create thread");
+            status = -1;
+            break;
+        }
+        n_started++;
+    }
+    // Without all threads the barriers would never open, so the started ones leave without running.
+    open_gate(&gate, n_started < n_threads);
+    for (size_t i = 0; i < n_started; i++) {
+        pthread_join(tids[i], NULL);
+        if (threads[i].status != 0) {
+            status = -1;
+        }
+    }
+    pthread_barrier_destroy(&barrier);
+    pthread_cond_destroy(&gate.cond);
+    pthread_mutex_destroy(&gate.mutex);
+
+    static const double arrays_touched[STREAM_N_KERNELS] = { 2.0, 2.0, 3.0, 3.0 };
+    for (size_t k = 0; status == 0 && k < STREAM_N_KERNELS; k++) {
+        double thread_bytes = arrays_touched[k] * sizeof(double) * (double)config->n_elements;
+        double bytes = thread_bytes * (double)n_threads;
+        result->best_mbps[k] = threads[0].best_ns[k] > 0 ? bytes / threads[0].best_ns[k] * 1e3 : 0.0;
+        for (size_t i = 0; i < n_threads; i++) {
+            double own_ns = threads[i].own_best_ns[k];
+            result->thread_best_mbps[i * STREAM_N_KERNELS + k] = own_ns > 0 ? thread_bytes / own_ns * 1e3 : 0.0;
+        }
+    }
+    free(threads);
+    free(tids);
+    return status;
+}
+
+void stream_result_free(stream_result_t* result)
+{
+    free(result->thread_best_mbps);
+    result->thread_best_mbps = NULL;
+    result->n_threads = 0;
+}
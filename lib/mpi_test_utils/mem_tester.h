@@ -0,0 +1,56 @@
+#ifndef MPI_TEST_UTILS_MEM_TESTER_H
+#define MPI_TEST_UTILS_MEM_TESTER_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { STREAM_COPY, STREAM_SCALE, STREAM_ADD, STREAM_TRIAD, STREAM_N_KERNELS } stream_kernel_t;
+
+const char* stream_kernel_name(stream_kernel_t kernel);
+
+typedef struct {
+    /*!
+     * @brief Length of each of the three arrays of every thread, in doubles.
+     */
+    size_t n_elements;
+    size_t n_threads;
+    size_t n_iterations;
+    /*!
+     * @brief NUMA node that threads and arrays are bound to, or -1 to leave placement to the OS.
+     */
+    int numa_node;
+} stream_config_t;
+
+typedef struct {
+    /*!
+     * @brief Aggregate bandwidth of all threads in MB/s, from the fastest iteration.
+     */
+    double best_mbps[STREAM_N_KERNELS];
+    /*!
+     * @brief Bandwidth of each thread alone in MB/s, from its own fastest iteration,
+     * at `[thread * STREAM_N_KERNELS + kernel]`. Freed by #stream_result_free.
+     */
+    double* thread_best_mbps;
+    size_t n_threads;
+} stream_result_t;
+
+/*!
+ * @brief STREAM copy/scale/add/triad kernels on per-thread arrays.
+ *
+ * Each thread binds itself and its arrays to `numa_node` before first touch, so placement does not depend
+ * on which thread happens to initialize memory. Threads run each kernel in lock-step between barriers.
+ *
+ * @return 0 on success, -1 on failure. `result` must be freed with #stream_result_free either way.
+ */
+int test_stream_nompi(const stream_config_t* config, stream_result_t* result);
+
+void stream_result_free(stream_result_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_MEM_TESTER_H
@@ -0,0 +1,288 @@
+// Enable POSIX and Linux extensions (O_DIRECT)
+#define _GNU_SOURCE // NOLINT
+
+#include "mpi_test_utils/mixed_workload.h"
+#include "mpi_test_utils/buffer_pool.h"
+#include "mpi_test_utils/pcg_basic.h"
+#include "mpi_test_utils/stats.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Threads report readiness after opening their files and wait until the gate opens, so that all start together.
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    size_t n_ready;
+    bool open;
+} start_gate_t;
+
+typedef struct {
+    const mixed_config_t* config;
+    bool is_writer;
+    size_t index;
+    size_t n_class_threads;
+    char* buffer;
+    start_gate_t* gate;
+    atomic_bool* stop;
+    int status;
+    uint64_t ops;
+    uint64_t bytes;
+    stats_hist_t latency_ns;
+} mixed_thread_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+void mixed_split_threads(size_t n_threads, unsigned read_percent, size_t* n_readers, size_t* n_writers)
+{
+    size_t readers = (n_threads * read_percent + 50) / 100;
+    if (read_percent > 0 && read_percent < 100 && n_threads >= 2) {
+        if (readers == 0) {
+            readers = 1;
+        }
+        if (readers == n_threads) {
+            readers = n_threads - 1;
+        }
+    }
+    *n_readers = readers;
+    *n_writers = n_threads - readers;
+}
+
+// Make sure readers have `file_blocks` blocks to read. Not timed.
+static int prepare_read_file(const mixed_config_t* config)
+{
+    size_t file_size = config->file_blocks * config->block_size;
+    struct stat st;
+    if (stat(config->read_file, &st) == 0 && (size_t)st.st_size >= file_size) {
+        return 0;
+    }
+    int fd = open(config->read_file, O_WRONLY | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        perror("Failed to open file for writing");
+        return -1;
+    }
+    char* buffer = buffer_pool_get(buffer_pool_shared(), BUFFER_SLOT_AUX, config->block_size);
+    if (buffer == NULL) {
+        close(fd);
+        return -1;
+    }
+    for (size_t i = 0; i < config->file_blocks; i++) {
+        if (pwrite(fd, buffer, config->block_size, (off_t)(i * config->block_size)) != (ssize_t)config->block_size) {
+            perror("Failed to write data");
+            close(fd);
+            return -1;
+        }
+    }
+    close(fd);
+    return 0;
+}
+
+// Write back and drop cached pages of `path`, if it exists, so that the next phase starts cold. Not timed.
+static int evict_file(const char* path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        if (errno == ENOENT) {
+            return 0;
+        }
+        perror("Failed to open file for eviction");
+        return -1;
+    }
+    // Dirty pages are not dropped, so they have to be written back first.
+    if (fdatasync(fd) != 0) {
+        perror("Failed to sync data");
+        close(fd);
+        return -1;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    return 0;
+}
+
+static void* mixed_thread_main(void* arg)
+{
+    mixed_thread_t* thread = arg;
+    const mixed_config_t* config = thread->config;
+    size_t block_size = config->block_size;
+    int flags = O_CLOEXEC | (config->direct ? O_DIRECT : 0);
+    int fd = thread->is_writer ? open(config->write_file, flags | O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR)
+                               : open(config->read_file, flags | O_RDONLY);
+    char* buffer = thread->buffer;
+    if (fd == -1) {
+        perror("Failed to open file");
+        thread->status = -1;
+    }
+    pcg32_random_t rng;
+    pcg32_srandom_r(&rng, (uint64_t)time(NULL), (uint64_t)(uintptr_t)thread);
+
+    // Each thread owns a slice of the file and walks it sequentially, wrapping around.
+    size_t slice = config->file_blocks / thread->n_class_threads;
+    if (slice == 0) {
+        slice = 1;
+    }
+    size_t first_block = (thread->index * slice) % config->file_blocks;
+    size_t step = 0;
+
+    pthread_mutex_lock(&thread->gate->mutex);
+    thread->gate->n_ready++;
+    pthread_cond_broadcast(&thread->gate->cond);
+    while (!thread->gate->open) {
+        pthread_cond_wait(&thread->gate->cond, &thread->gate->mutex);
+    }
+    pthread_mutex_unlock(&thread->gate->mutex);
+
+    while (thread->status == 0 && !atomic_load_explicit(thread->stop, memory_order_relaxed)) {
+        size_t block = first_block + step % slice;
+        if (!thread->is_writer && config->random_reads) {
+            block = pcg32_boundedrand_r(&rng, (uint32_t)config->file_blocks);
+        }
+        step++;
+        off_t offset = (off_t)(block * block_size);
+        uint64_t start = now_ns();
+        ssize_t done
+            = thread->is_writer ? pwrite(fd, buffer, block_size, offset) : pread(fd, buffer, block_size, offset);
+        if (done != (ssize_t)block_size) {
+            perror(thread->is_writer ? "Failed to write data" : "Failed to read data");
+            thread->status = -1;
+            break;
+        }
+        if (thread->is_writer && config->sync_interval > 0 && step % config->sync_interval == 0
+            && fdatasync(fd) != 0) {
+            perror("Failed to sync data");
+            thread->status = -1;
+            break;
+        }
+        uint64_t end = now_ns();
+        stats_hist_add(&thread->latency_ns, end - start);
+        thread->ops++;
+        thread->bytes += block_size;
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+    return NULL;
+}
+
+static void collect_class(
+    const mixed_thread_t* threads, size_t n_threads, bool is_writer, uint64_t elapsed_ns, mixed_class_stats_t* out)
+{
+    memset(out, 0, sizeof(mixed_class_stats_t));
+    stats_hist_init(&out->latency_ns);
+    out->elapsed_ns = elapsed_ns;
+    for (size_t i = 0; i < n_threads; i++) {
+        if (threads[i].is_writer != is_writer) {
+            continue;
+        }
+        out->n_threads++;
+        out->ops += threads[i].ops;
+        out->bytes += threads[i].bytes;
+        stats_hist_merge(&out->latency_ns, &threads[i].latency_ns);
+    }
+}
+
+int test_mixed_nompi(const mixed_config_t* config, mixed_class_stats_t* read_stats, mixed_class_stats_t* write_stats)
+{
+    size_t n_threads = config->n_readers + config->n_writers;
+    if (n_threads == 0 || config->file_blocks == 0 || config->block_size == 0) {
+        fprintf(stderr, "Mixed workload needs at least one thread and a non-empty file\n");
+        return -1;
+    }
+    if (config->n_readers > 0 && prepare_read_file(config) != 0) {
+        return -1;
+    }
+    if (evict_file(config->read_file) != 0
+        || (strcmp(config->write_file, config->read_file) != 0 && evict_file(config->write_file) != 0)) {
+        return -1;
+    }
+    mixed_thread_t* threads = calloc(n_threads, sizeof(mixed_thread_t));
+    pthread_t* tids = calloc(n_threads, sizeof(pthread_t));
+    if (threads == NULL || tids == NULL) {
+        perror("Failed to allocate threads");
+        free(threads);
+        free(tids);
+        return -1;
+    }
+    start_gate_t gate = { .n_ready = 0, .open = false };
+    pthread_mutex_init(&gate.mutex, NULL);
+    pthread_cond_init(&gate.cond, NULL);
+    atomic_bool stop;
+    atomic_init(&stop, false);
+
+    size_t n_started = 0;
+    for (size_t i = 0; i < n_threads; i++) {
+        mixed_thread_t* thread = &threads[i];
+        thread->config = config;
+        thread->is_writer = i >= config->n_readers;
+        thread->index = thread->is_writer ? i - config->n_readers : i;
+        thread->n_class_threads = thread->is_writer ? config->n_writers : config->n_readers;
+        thread->gate = &gate;
+        thread->stop = &stop;
+        stats_hist_init(&thread->latency_ns);
+        // Buffers are mapped here, before any thread starts its clock.
+        thread->buffer = buffer_pool_get(buffer_pool_shared(), BUFFER_SLOT_THREADS + i, config->block_size);
+        if (thread->buffer == NULL) {
+            thread->status = -1;
+            break;
+        }
+        if (pthread_create(&tids[i], NULL, mixed_thread_main, thread) != 0) {
+            perror("Failed to create thread");
+            thread->status = -1;
+            break;
+        }
+        n_started++;
+    }
+    if (n_started < n_threads) {
+        // Let the threads already started leave right away.
+        atomic_store(&stop, true);
+    }
+
+    pthread_mutex_lock(&gate.mutex);
+    while (gate.n_ready < n_started) {
+        pthread_cond_wait(&gate.cond, &gate.mutex);
+    }
+    gate.open = true;
+    pthread_cond_broadcast(&gate.cond);
+    pthread_mutex_unlock(&gate.mutex);
+
+    uint64_t start = now_ns();
+    if (n_started == n_threads) {
+        struct timespec duration
+            = { (time_t)(config->duration_ns / 1000000000), (long)(config->duration_ns % 1000000000) };
+        while (nanosleep(&duration, &duration) != 0 && errno == EINTR) { }
+        atomic_store(&stop, true);
+    }
+    for (size_t i = 0; i < n_started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    uint64_t elapsed_ns = now_ns() - start;
+    pthread_cond_destroy(&gate.cond);
+    pthread_mutex_destroy(&gate.mutex);
+
+    int status = 0;
+    for (size_t i = 0; i < n_threads; i++) {
+        if (threads[i].status != 0) {
+            status = -1;
+        }
+    }
+    collect_class(threads, n_threads, false, elapsed_ns, read_stats);
+    collect_class(threads, n_threads, true, elapsed_ns, write_stats);
+    free(threads);
+    free(tids);
+    return status;
+}
@@ -0,0 +1,80 @@
+#ifndef MPI_TEST_UTILS_MIXED_WORKLOAD_H
+#define MPI_TEST_UTILS_MIXED_WORKLOAD_H
+
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/stats.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    /*!
+     * @brief File read by reader threads. Created or extended to `file_blocks` blocks if needed.
+     */
+    const char* read_file;
+    /*!
+     * @brief File written by writer threads. May be the same as `read_file`.
+     */
+    const char* write_file;
+    size_t block_size;
+    /*!
+     * @brief Size of each file in blocks. Writers cycle over this range.
+     */
+    size_t file_blocks;
+    size_t n_readers;
+    size_t n_writers;
+    uint64_t duration_ns;
+    /*!
+     * @brief Readers pick uniformly random blocks instead of reading sequentially.
+     */
+    bool random_reads;
+    /*!
+     * @brief Open both files with O_DIRECT. `block_size` must be a multiple of the logical block size.
+     */
+    bool direct;
+    /*!
+     * @brief Writers fdatasync after every `sync_interval` writes, within the latency of that write. 0 never syncs.
+     */
+    size_t sync_interval;
+} mixed_config_t;
+
+typedef struct {
+    size_t n_threads;
+    uint64_t ops;
+    uint64_t bytes;
+    uint64_t elapsed_ns;
+    /*!
+     * @brief Per-operation latency in nanoseconds, merged over all threads of the class.
+     */
+    stats_hist_t latency_ns;
+} mixed_class_stats_t;
+
+/*!
+ * @brief Split `n_threads` into readers and writers so that readers make up `read_percent` percent.
+ *
+ * Each class gets at least one thread unless its share is exactly 0 or 100 %.
+ */
+void mixed_split_threads(size_t n_threads, unsigned read_percent, size_t* n_readers, size_t* n_writers);
+
+/*!
+ * @brief Run readers and writers concurrently with pread/pwrite for `duration_ns`.
+ *
+ * Both files are synced and evicted from the page cache before the threads start, so that reads hit storage
+ * at least until the page cache warms up again. All threads are released together and stopped together.
+ * Statistics are collected per class.
+ * @return 0 on success, -1 on failure.
+ */
+int test_mixed_nompi(const mixed_config_t* config, mixed_class_stats_t* read_stats, mixed_class_stats_t* write_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_MIXED_WORKLOAD_H
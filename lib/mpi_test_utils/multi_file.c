@@ -0,0 +1,236 @@
+// fsetxattr and O_ASYNC need Linux extensions
+#define _GNU_SOURCE // NOLINT
+
+#include "mpi_test_utils/multi_file.h"
+#include "mpi_test_utils/buffer_pool.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <time.h>
+#include <unistd.h>
+
+// From lustre_user.h, which is not installed on most clients.
+#define LOV_USER_MAGIC_V1 0x0BD10BD0
+#define LOV_PATTERN_RAID0 0x1
+#define LOV_USER_MD_V1_SIZE 32
+// Opening with these flags together makes the Lustre client postpone object allocation,
+// so that the layout can still be set. Other filesystems ignore them on regular files.
+#define LOV_DELAY_CREATE (O_NOCTTY | O_ASYNC)
+
+// Threads report readiness after opening their files and wait until the gate opens, so that all start together.
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    size_t n_ready;
+    bool open;
+} multi_file_gate_t;
+
+typedef struct {
+    const multi_file_config_t* config;
+    size_t index;
+    bool write;
+    char* buffer;
+    multi_file_gate_t* gate;
+    int status;
+    bool striped;
+} multi_file_thread_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+void multi_file_path(char* path, const multi_file_config_t* config, size_t i)
+{
+    size_t global = config->first_index + i;
+    snprintf(path, MULTI_FILE_PATH_LEN, "%s/multi_file.%zu", config->dirs[global % config->n_dirs], global);
+}
+
+int multi_file_set_stripe(int fd, unsigned stripe_count, size_t stripe_size)
+{
+    // lmm_magic, lmm_pattern, lmm_oi (16 bytes), lmm_stripe_size, lmm_stripe_count, lmm_stripe_offset.
+    unsigned char lum[LOV_USER_MD_V1_SIZE] = { 0 };
+    uint32_t magic = LOV_USER_MAGIC_V1;
+    uint32_t pattern = LOV_PATTERN_RAID0;
+    uint32_t size = (uint32_t)stripe_size;
+    uint16_t count = (uint16_t)stripe_count;
+    uint16_t offset = 0xFFFF; // Any OST
+    memcpy(lum, &magic, sizeof(magic));
+    memcpy(lum + 4, &pattern, sizeof(pattern));
+    memcpy(lum + 24, &size, sizeof(size));
+    memcpy(lum + 28, &count, sizeof(count));
+    memcpy(lum + 30, &offset, sizeof(offset));
+    return fsetxattr(fd, "lustre.lov", lum, sizeof(lum), 0);
+}
+
+// Not timed: recreate the file with its stripe hint for writing, or evict it from the page cache for reading.
+static int open_file(multi_file_thread_t* thread, const char* path)
+{
+    const multi_file_config_t* config = thread->config;
+    if (!thread->write) {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            perror("Failed to open file for reading");
+            return -1;
+        }
+        // Files written without sync are still dirty, and dirty pages are not dropped.
+        if (fdatasync(fd) != 0) {
+            perror("Failed to sync file");
+            close(fd);
+            return -1;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        return fd;
+    }
+    bool hint = config->stripe_count != 0 || config->stripe_size != 0;
+    if (unlink(path) != 0 && errno != ENOENT) {
+        perror("Failed to remove previous file");
+        return -1;
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC | (hint ? LOV_DELAY_CREATE : 0), S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        perror("Failed to open file for writing");
+        return -1;
+    }
+    thread->striped = hint && multi_file_set_stripe(fd, config->stripe_count, config->stripe_size) == 0;
+    return fd;
+}
+
+static void* multi_file_thread_main(void* arg)
+{
+    multi_file_thread_t* thread = arg;
+    const multi_file_config_t* config = thread->config;
+    char path[MULTI_FILE_PATH_LEN];
+    multi_file_path(path, config, thread->index);
+    int fd = open_file(thread, path);
+    if (fd == -1) {
+        thread->status = -1;
+    }
+
+    multi_file_gate_t* gate = thread->gate;
+    pthread_mutex_lock(&gate->mutex);
+    gate->n_ready++;
+    pthread_cond_broadcast(&gate->cond);
+    while (!gate->open) {
+        pthread_cond_wait(&gate->cond, &gate->mutex);
+    }
+    pthread_mutex_unlock(&gate->mutex);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    for (size_t offset = 0; offset < config->file_size; offset += config->block_size) {
+        size_t len = config->file_size - offset < config->block_size ? config->file_size - offset : config->block_size;
+        ssize_t done = thread->write ? pwrite(fd, thread->buffer, len, (off_t)offset)
+                                     : pread(fd, thread->buffer, len, (off_t)offset);
+        if (done != (ssize_t)len) {
+            perror(thread->write ? "Failed to write data" : "Failed to read data");
+            thread->status = -1;
+            break;
+        }
+    }
+    if (thread->status == 0 && thread->write && config->sync && fdatasync(fd) != 0) {
+        perror("Failed to sync data");
+        thread->status = -1;
+    }
+    close(fd);
+    return NULL;
+}
+
+static ssize_t test_multi_file(const multi_file_config_t* config, bool write, size_t* n_striped)
+{
+    if (config->n_files == 0 || config->n_dirs == 0 || config->block_size == 0) {
+        fprintf(stderr, "Multi-file test needs at least one file, one directory and a non-zero block size\n");
+        return -1;
+    }
+    multi_file_thread_t* threads = calloc(config->n_files, sizeof(multi_file_thread_t));
+    pthread_t* tids = calloc(config->n_files, sizeof(pthread_t));
+    if (threads == NULL || tids == NULL) {
+        perror("Failed to allocate threads");
+        free(threads);
+        free(tids);
+        return -1;
+    }
+    multi_file_gate_t gate = { .n_ready = 0, .open = false };
+    pthread_mutex_init(&gate.mutex, NULL);
+    pthread_cond_init(&gate.cond, NULL);
+
+    size_t n_started = 0;
+    for (size_t i = 0; i < config->n_files; i++) {
+        multi_file_thread_t* thread = &threads[i];
+        thread->config = config;
+        thread->index = i;
+        thread->write = write;
+        thread->gate = &gate;
+        // Buffers are mapped here, before the clock starts.
+        thread->buffer = buffer_pool_get(buffer_pool_shared(), BUFFER_SLOT_THREADS + i, config->block_size);
+        if (thread->buffer == NULL) {
+            thread->status = -1;
+            break;
+        }
+        if (pthread_create(&tids[i], NULL, multi_file_thread_main, thread) != 0) {
+            perror("Failed to create thread");
+            thread->status = -1;
+            break;
+        }
+        n_started++;
+    }
+
+    pthread_mutex_lock(&gate.mutex);
+    while (gate.n_ready < n_started) {
+        pthread_cond_wait(&gate.cond, &gate.mutex);
+    }
+    uint64_t start = now_ns();
+    gate.open = true;
+    pthread_cond_broadcast(&gate.cond);
+    pthread_mutex_unlock(&gate.mutex);
+    for (size_t i = 0; i < n_started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    uint64_t elapsed_ns = now_ns() - start;
+    pthread_cond_destroy(&gate.cond);
+    pthread_mutex_destroy(&gate.mutex);
+
+    int status = n_started == config->n_files ? 0 : -1;
+    if (n_striped != NULL) {
+        *n_striped = 0;
+    }
+    for (size_t i = 0; i < n_started; i++) {
+        if (threads[i].status != 0) {
+            status = -1;
+        }
+        if (n_striped != NULL && threads[i].striped) {
+            (*n_striped)++;
+        }
+    }
+    free(threads);
+    free(tids);
+    return status == 0 ? (ssize_t)elapsed_ns : -1;
+}
+
+ssize_t test_multi_file_write_nompi(const multi_file_config_t* config, size_t* n_striped)
+{
+    return test_multi_file(config, true, n_striped);
+}
+
+ssize_t test_multi_file_read_nompi(const multi_file_config_t* config) { return test_multi_file(config, false, NULL); }
+
+void multi_file_remove(const multi_file_config_t* config)
+{
+    char path[MULTI_FILE_PATH_LEN];
+    for (size_t i = 0; i < config->n_files; i++) {
+        multi_file_path(path, config, i);
+        unlink(path);
+    }
+}
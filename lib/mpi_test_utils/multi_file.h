@@ -0,0 +1,87 @@
+#ifndef MPI_TEST_UTILS_MULTI_FILE_H
+#define MPI_TEST_UTILS_MULTI_FILE_H
+
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @file multi_file.h
+ * @brief Concurrent transfers to several files spread over several target directories, e.g. one per Lustre OST
+ * pool or BeeGFS storage target, to measure how aggregate bandwidth scales with file and target count.
+ */
+
+#define MULTI_FILE_PATH_LEN 4096
+
+typedef struct {
+    /*!
+     * @brief Target directories. File with global index `g` lives in `dirs[g % n_dirs]`.
+     */
+    const char* const* dirs;
+    size_t n_dirs;
+    /*!
+     * @brief Files transferred concurrently by this process, one thread each.
+     */
+    size_t n_files;
+    /*!
+     * @brief Global index of the first file of this process, so that processes do not share files.
+     */
+    size_t first_index;
+    size_t file_size;
+    size_t block_size;
+    /*!
+     * @brief fdatasync every written file inside the timed region.
+     */
+    bool sync;
+    /*!
+     * @brief Lustre stripe count of new files, 0 to inherit the directory layout.
+     */
+    unsigned stripe_count;
+    /*!
+     * @brief Lustre stripe size of new files in bytes, 0 for the filesystem default.
+     */
+    size_t stripe_size;
+} multi_file_config_t;
+
+/*!
+ * @brief Path of the `i`-th file of this process.
+ */
+void multi_file_path(char* path, const multi_file_config_t* config, size_t i);
+
+/*!
+ * @brief Set the Lustre layout of a file that has no data objects yet through the "lustre.lov" attribute.
+ * @return 0 on success, -1 with errno set otherwise, e.g. ENOTSUP on other filesystems.
+ */
+int multi_file_set_stripe(int fd, unsigned stripe_count, size_t stripe_size);
+
+/*!
+ * @brief Recreate and write all files concurrently. Creating files and applying stripe hints is not timed.
+ * @param n_striped Receives the number of files whose stripe hint was applied. May be NULL.
+ * @return Elapsed time in nanoseconds until the last file is written, or -1 on failure.
+ */
+ssize_t test_multi_file_write_nompi(const multi_file_config_t* config, size_t* n_striped);
+
+/*!
+ * @brief Read back all files concurrently after syncing and dropping them from the page cache, untimed.
+ * @return Elapsed time in nanoseconds until the last file is read, or -1 on failure.
+ */
+ssize_t test_multi_file_read_nompi(const multi_file_config_t* config);
+
+/*!
+ * @brief Remove the files of this process.
+ */
+void multi_file_remove(const multi_file_config_t* config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_MULTI_FILE_H
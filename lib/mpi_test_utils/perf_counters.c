@@ -0,0 +1,187 @@
+// perf_event_open and syscall() are Linux-specific
+#define _GNU_SOURCE // NOLINT
+
+#include "mpi_test_utils/perf_counters.h"
+#include "mpi_test_utils/fmt.h"
+
+#include <linux/perf_event.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} perf_events[PERF_N_EVENTS] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+};
+
+// Keys of /proc/self/io in the order stored in perf_region_t::io.
+static const char* proc_io_keys[] = { "rchar", "wchar", "syscr", "syscw", "read_bytes", "write_bytes" };
+
+static int open_counter(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_hv = 1;
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    if (fd == -1 && (errno == EACCES || errno == EPERM)) {
+        // perf_event_paranoid forbids kernel profiling, so count user space only.
+        attr.exclude_kernel = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    }
+    return fd;
+}
+
+static void read_proc_io(int64_t* io)
+{
+    for (size_t i = 0; i < 6; i++) {
+        io[i] = -1;
+    }
+    FILE* file = fopen("/proc/self/io", "re");
+    if (file == NULL) {
+        return;
+    }
+    char key[32];
+    long long value;
+    while (fscanf(file, "%31[^:]: %lld\n", key, &value) == 2) {
+        for (size_t i = 0; i < 6; i++) {
+            if (strcmp(key, proc_io_keys[i]) == 0) {
+                io[i] = value;
+            }
+        }
+    }
+    fclose(file);
+}
+
+void perf_region_begin(perf_region_t* region)
+{
+    for (size_t i = 0; i < PERF_N_EVENTS; i++) {
+        region->fds[i] = open_counter(perf_events[i].type, perf_events[i].config);
+    }
+    getrusage(RUSAGE_SELF, &region->usage);
+    read_proc_io(region->io);
+    for (size_t i = 0; i < PERF_N_EVENTS; i++) {
+        if (region->fds[i] != -1) {
+            ioctl(region->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(region->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+static int64_t read_counter(int fd)
+{
+    if (fd == -1) {
+        return -1;
+    }
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t value = 0;
+    if (read(fd, &value, sizeof(value)) != sizeof(value)) {
+        return -1;
+    }
+    return (int64_t)value;
+}
+
+static int64_t io_delta(const int64_t* start, const int64_t* end, size_t idx)
+{
+    return (start[idx] < 0 || end[idx] < 0) ? -1 : end[idx] - start[idx];
+}
+
+void perf_region_end(perf_region_t* region, perf_sample_t* out)
+{
+    out->cycles = read_counter(region->fds[0]);
+    out->instructions = read_counter(region->fds[1]);
+    out->context_switches = read_counter(region->fds[2]);
+    out->page_faults = read_counter(region->fds[3]);
+    perf_region_cancel(region);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    out->minor_faults = usage.ru_minflt - region->usage.ru_minflt;
+    out->major_faults = usage.ru_majflt - region->usage.ru_majflt;
+    out->voluntary_switches = usage.ru_nvcsw - region->usage.ru_nvcsw;
+    out->involuntary_switches = usage.ru_nivcsw - region->usage.ru_nivcsw;
+
+    int64_t io[6];
+    read_proc_io(io);
+    out->read_chars = io_delta(region->io, io, 0);
+    out->write_chars = io_delta(region->io, io, 1);
+    out->read_syscalls = io_delta(region->io, io, 2);
+    out->write_syscalls = io_delta(region->io, io, 3);
+    out->storage_read_bytes = io_delta(region->io, io, 4);
+    out->storage_write_bytes = io_delta(region->io, io, 5);
+}
+
+void perf_region_cancel(perf_region_t* region)
+{
+    for (size_t i = 0; i < PERF_N_EVENTS; i++) {
+        if (region->fds[i] != -1) {
+            close(region->fds[i]);
+            region->fds[i] = -1;
+        }
+    }
+}
+
+static void print_count(FILE* out, const char* name, int64_t value)
+{
+    if (value < 0) {
+        fprintf(out, " %s=n/a", name);
+        return;
+    }
+    char* value_str = format_with_comma_64(value);
+    fprintf(out, " %s=%s", name, value_str);
+    free(value_str);
+}
+
+static void print_bytes(FILE* out, const char* name, int64_t value)
+{
+    if (value < 0) {
+        fprintf(out, " %s=n/a", name);
+        return;
+    }
+    char* value_str = format_with_si_64(value, 2);
+    fprintf(out, " %s=%s", name, value_str);
+    free(value_str);
+}
+
+void perf_sample_print(const perf_sample_t* sample, FILE* out)
+{
+    fprintf(out, "  cpu:");
+    print_count(out, "cycles", sample->cycles);
+    print_count(out, "instructions", sample->instructions);
+    if (sample->cycles > 0 && sample->instructions >= 0) {
+        fprintf(out, " ipc=%.2f", (double)sample->instructions / (double)sample->cycles);
+    }
+    fprintf(out, "\n  sched:");
+    print_count(out, "ctx_switches", sample->context_switches);
+    print_count(out, "voluntary", sample->voluntary_switches);
+    print_count(out, "involuntary", sample->involuntary_switches);
+    fprintf(out, "\n  memory:");
+    print_count(out, "page_faults", sample->page_faults);
+    print_count(out, "minor", sample->minor_faults);
+    print_count(out, "major", sample->major_faults);
+    fprintf(out, "\n  syscalls:");
+    print_count(out, "read", sample->read_syscalls);
+    print_count(out, "write", sample->write_syscalls);
+    print_bytes(out, "read_chars", sample->read_chars);
+    print_bytes(out, "write_chars", sample->write_chars);
+    fprintf(out, "\n  storage:");
+    print_bytes(out, "read", sample->storage_read_bytes);
+    print_bytes(out, "write", sample->storage_write_bytes);
+    fprintf(out, "\n");
+}
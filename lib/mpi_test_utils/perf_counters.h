@@ -0,0 +1,64 @@
+#ifndef MPI_TEST_UTILS_PERF_COUNTERS_H
+#define MPI_TEST_UTILS_PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/resource.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERF_N_EVENTS 4
+
+/*!
+ * @brief Counter deltas over a timed region. Counters that are unavailable on this system are set to -1.
+ */
+typedef struct {
+    // From perf_event_open.
+    int64_t cycles;
+    int64_t instructions;
+    int64_t context_switches;
+    int64_t page_faults;
+    // From getrusage.
+    int64_t minor_faults;
+    int64_t major_faults;
+    int64_t voluntary_switches;
+    int64_t involuntary_switches;
+    // From /proc/self/io.
+    int64_t read_syscalls;
+    int64_t write_syscalls;
+    int64_t read_chars;
+    int64_t write_chars;
+    int64_t storage_read_bytes;
+    int64_t storage_write_bytes;
+} perf_sample_t;
+
+typedef struct {
+    int fds[PERF_N_EVENTS];
+    struct rusage usage;
+    int64_t io[6];
+} perf_region_t;
+
+/*!
+ * @brief Open counters and take a snapshot. Never fails; missing counters are reported as -1.
+ */
+void perf_region_begin(perf_region_t* region);
+
+/*!
+ * @brief Read deltas since #perf_region_begin into `out` and close counters.
+ */
+void perf_region_end(perf_region_t* region, perf_sample_t* out);
+
+/*!
+ * @brief Close counters without reading them.
+ */
+void perf_region_cancel(perf_region_t* region);
+
+void perf_sample_print(const perf_sample_t* sample, FILE* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_PERF_COUNTERS_H
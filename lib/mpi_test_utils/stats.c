@@ -0,0 +1,241 @@
+#include "mpi_test_utils/stats.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int compare_double(const void* a, const void* b)
+{
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+static double* sorted_copy(const double* values, size_t n)
+{
+    double* sorted = malloc(n * sizeof(double));
+    if (sorted == NULL) {
+        return NULL;
+    }
+    memcpy(sorted, values, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), compare_double);
+    return sorted;
+}
+
+double stats_median(const double* values, size_t n)
+{
+    if (n == 0) {
+        return NAN;
+    }
+    double* sorted = sorted_copy(values, n);
+    if (sorted == NULL) {
+        return NAN;
+    }
+    double median = (n % 2 == 1) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+    free(sorted);
+    return median;
+}
+
+double stats_mad(const double* values, size_t n)
+{
+    double median = stats_median(values, n);
+    if (isnan(median)) {
+        return NAN;
+    }
+    double* deviations = malloc(n * sizeof(double));
+    if (deviations == NULL) {
+        return NAN;
+    }
+    for (size_t i = 0; i < n; i++) {
+        deviations[i] = fabs(values[i] - median);
+    }
+    double mad = stats_median(deviations, n);
+    free(deviations);
+    return mad;
+}
+
+double stats_quantile(const double* values, size_t n, double q)
+{
+    if (n == 0) {
+        return NAN;
+    }
+    double* sorted = sorted_copy(values, n);
+    if (sorted == NULL) {
+        return NAN;
+    }
+    double pos = q * (double)(n - 1);
+    size_t lower = (size_t)pos;
+    double quantile = sorted[lower];
+    if (lower + 1 < n) {
+        quantile += (pos - (double)lower) * (sorted[lower + 1] - sorted[lower]);
+    }
+    free(sorted);
+    return quantile;
+}
+
+int stats_median_ci(const double* values, size_t n, double confidence, double* lo, double* hi)
+{
+    if (n == 0) {
+        return -1;
+    }
+    double* sorted = sorted_copy(values, n);
+    if (sorted == NULL) {
+        return -1;
+    }
+    // Find the largest k such that P(Binomial(n, 0.5) <= k) <= alpha / 2.
+    // The interval is then [x_(k + 1), x_(n - k)] in 1-based order statistics.
+    double half_alpha = (1.0 - confidence) / 2.0;
+    double pmf = pow(0.5, (double)n); // P(X = 0)
+    double cdf = pmf;
+    size_t k = 0;
+    if (cdf > half_alpha) {
+        // Too few samples for the requested confidence; fall back to the full range.
+        *lo = sorted[0];
+        *hi = sorted[n - 1];
+        free(sorted);
+        return 0;
+    }
+    while (k + 1 < n / 2) {
+        pmf = pmf * (double)(n - k) / (double)(k + 1);
+        if (cdf + pmf > half_alpha) {
+            break;
+        }
+        cdf += pmf;
+        k++;
+    }
+    *lo = sorted[k];
+    *hi = sorted[n - k - 1];
+    free(sorted);
+    return 0;
+}
+
+typedef struct {
+    double value;
+    int group;
+} ranked_value_t;
+
+static int compare_ranked(const void* a, const void* b)
+{
+    return compare_double(&((const ranked_value_t*)a)->value, &((const ranked_value_t*)b)->value);
+}
+
+double stats_mann_whitney_greater(const double* a, size_t na, const double* b, size_t nb)
+{
+    size_t n = na + nb;
+    if (na == 0 || nb == 0) {
+        return 1.0;
+    }
+    ranked_value_t* all = malloc(n * sizeof(ranked_value_t));
+    if (all == NULL) {
+        return 1.0;
+    }
+    for (size_t i = 0; i < na; i++) {
+        all[i].value = a[i];
+        all[i].group = 0;
+    }
+    for (size_t i = 0; i < nb; i++) {
+        all[na + i].value = b[i];
+        all[na + i].group = 1;
+    }
+    qsort(all, n, sizeof(ranked_value_t), compare_ranked);
+
+    // Assign mid-ranks to ties and accumulate the tie correction term.
+    double rank_sum_a = 0.0;
+    double tie_term = 0.0;
+    size_t i = 0;
+    while (i < n) {
+        size_t j = i + 1;
+        while (j < n && all[j].value == all[i].value) {
+            j++;
+        }
+        double mid_rank = ((double)(i + 1) + (double)j) / 2.0;
+        for (size_t t = i; t < j; t++) {
+            if (all[t].group == 0) {
+                rank_sum_a += mid_rank;
+            }
+        }
+        double tie_len = (double)(j - i);
+        tie_term += tie_len * tie_len * tie_len - tie_len;
+        i = j;
+    }
+    free(all);
+
+    double dna = (double)na;
+    double dnb = (double)nb;
+    double dn = (double)n;
+    double u_a = rank_sum_a - dna * (dna + 1.0) / 2.0;
+    double mean = dna * dnb / 2.0;
+    double var = dna * dnb / 12.0 * ((dn + 1.0) - tie_term / (dn * (dn - 1.0)));
+    if (var <= 0.0) {
+        return 1.0;
+    }
+    double z = (u_a - mean - 0.5) / sqrt(var);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+void stats_hist_init(stats_hist_t* hist) { memset(hist, 0, sizeof(stats_hist_t)); }
+
+static size_t hist_bucket(uint64_t value)
+{
+    if (value < STATS_HIST_SUB) {
+        return (size_t)value;
+    }
+    unsigned msb = 63U - (unsigned)__builtin_clzll(value);
+    unsigned shift = msb - STATS_HIST_SUB_BITS;
+    return (size_t)(shift + 1) * STATS_HIST_SUB + (size_t)((value >> shift) & (STATS_HIST_SUB - 1));
+}
+
+static double hist_bucket_midpoint(size_t idx)
+{
+    if (idx < STATS_HIST_SUB) {
+        return (double)idx;
+    }
+    unsigned shift = (unsigned)(idx / STATS_HIST_SUB) - 1;
+    double lower = (double)((STATS_HIST_SUB + idx % STATS_HIST_SUB) << shift);
+    return lower + (double)(1ULL << shift) / 2.0;
+}
+
+void stats_hist_add(stats_hist_t* hist, uint64_t value)
+{
+    hist->counts[hist_bucket(value)]++;
+    hist->n++;
+    hist->sum += (double)value;
+    if (value > hist->max) {
+        hist->max = value;
+    }
+}
+
+void stats_hist_merge(stats_hist_t* dst, const stats_hist_t* src)
+{
+    for (size_t i = 0; i < STATS_HIST_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->n += src->n;
+    dst->sum += src->sum;
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+double stats_hist_mean(const stats_hist_t* hist) { return hist->n == 0 ? NAN : hist->sum / (double)hist->n; }
+
+double stats_hist_quantile(const stats_hist_t* hist, double q)
+{
+    if (hist->n == 0) {
+        return NAN;
+    }
+    if (q >= 1.0) {
+        return (double)hist->max;
+    }
+    uint64_t target = (uint64_t)(q * (double)(hist->n - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < STATS_HIST_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= target) {
+            double midpoint = hist_bucket_midpoint(i);
+            return midpoint > (double)hist->max ? (double)hist->max : midpoint;
+        }
+    }
+    return (double)hist->max;
+}
@@ -0,0 +1,77 @@
+#ifndef MPI_TEST_UTILS_STATS_H
+#define MPI_TEST_UTILS_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STATS_HIST_SUB_BITS 4
+#define STATS_HIST_SUB (1U << STATS_HIST_SUB_BITS)
+#define STATS_HIST_BUCKETS (64 * STATS_HIST_SUB)
+
+/*!
+ * @brief Log-linear histogram of non-negative integers, e.g. latencies in nanoseconds.
+ *
+ * Each power of two is split into #STATS_HIST_SUB buckets, so quantiles are accurate within about 6 %
+ * while adding a value costs a few instructions and no allocation.
+ */
+typedef struct {
+    uint64_t counts[STATS_HIST_BUCKETS];
+    uint64_t n;
+    uint64_t max;
+    double sum;
+} stats_hist_t;
+
+/*!
+ * @brief Median of `n` values. The input is not modified. Returns NaN if `n` is zero.
+ */
+double stats_median(const double* values, size_t n);
+
+/*!
+ * @brief Median absolute deviation from the median. The input is not modified. Returns NaN if `n` is zero.
+ */
+double stats_mad(const double* values, size_t n);
+
+/*!
+ * @brief Quantile `q` in [0, 1] of `n` values with linear interpolation. The input is not modified.
+ * Returns NaN if `n` is zero.
+ */
+double stats_quantile(const double* values, size_t n, double q);
+
+/*!
+ * @brief Distribution-free confidence interval of the median.
+ *
+ * The bounds are order statistics chosen from the Binomial(n, 0.5) distribution,
+ * so no normality assumption is made on the samples.
+ * For very small `n` the interval degenerates to [min, max].
+ *
+ * @return 0 on success, -1 if `n` is zero.
+ */
+int stats_median_ci(const double* values, size_t n, double confidence, double* lo, double* hi);
+
+/*!
+ * @brief One-sided Mann-Whitney U test.
+ *
+ * Returns the p-value of the hypothesis that values in `a` tend to be greater than values in `b`.
+ * Normal approximation with tie and continuity correction is used.
+ */
+double stats_mann_whitney_greater(const double* a, size_t na, const double* b, size_t nb);
+
+void stats_hist_init(stats_hist_t* hist);
+void stats_hist_add(stats_hist_t* hist, uint64_t value);
+void stats_hist_merge(stats_hist_t* dst, const stats_hist_t* src);
+double stats_hist_mean(const stats_hist_t* hist);
+
+/*!
+ * @brief Approximate quantile `q` in [0, 1]. Returns NaN for an empty histogram.
+ */
+double stats_hist_quantile(const stats_hist_t* hist, double q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_STATS_H
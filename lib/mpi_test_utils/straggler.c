@@ -0,0 +1,160 @@
+#include "mpi_test_utils/straggler.h"
+#include "mpi_test_utils/stats.h"
+
+#include <mpi.h>
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Scales the MAD to the standard deviation of a normal distribution.
+#define MAD_TO_SIGMA 0.6745
+// Same for the mean absolute deviation, used when more than half of the results are identical.
+#define MEAN_AD_TO_SIGMA 0.7979
+
+typedef struct {
+    double value;
+    char hostname[MPI_MAX_PROCESSOR_NAME];
+} rank_result_t;
+
+static int compare_z_desc(const void* a, const void* b)
+{
+    double za = ((const straggler_t*)a)->z;
+    double zb = ((const straggler_t*)b)->z;
+    return (za < zb) - (za > zb);
+}
+
+// Fill `report` from all results at the root. Returns -1 on allocation failure.
+static int find_stragglers(const rank_result_t* all, int size, bool higher_is_better, double z_threshold,
+    straggler_report_t* report)
+{
+    double* values = calloc((size_t)size, sizeof(double));
+    if (values == NULL) {
+        return -1;
+    }
+    size_t n = 0;
+    for (int r = 0; r < size; r++) {
+        if (!isnan(all[r].value)) {
+            values[n++] = all[r].value;
+        }
+    }
+    report->median = stats_median(values, n);
+    report->mad = stats_mad(values, n);
+    double scale = report->mad / MAD_TO_SIGMA;
+    if (scale == 0.0 && n > 0) {
+        double mean_ad = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            mean_ad += fabs(values[i] - report->median);
+        }
+        scale = mean_ad / (double)n / MEAN_AD_TO_SIGMA;
+    }
+    free(values);
+    if (n < 3 || !(scale > 0.0)) {
+        return 0;
+    }
+    report->stragglers = calloc((size_t)size, sizeof(straggler_t));
+    if (report->stragglers == NULL) {
+        return -1;
+    }
+    for (int r = 0; r < size; r++) {
+        if (isnan(all[r].value)) {
+            continue;
+        }
+        double diff = higher_is_better ? report->median - all[r].value : all[r].value - report->median;
+        double z = diff / scale;
+        if (z > z_threshold) {
+            straggler_t* straggler = &report->stragglers[report->n_stragglers++];
+            straggler->rank = r;
+            memcpy(straggler->hostname, all[r].hostname, MPI_MAX_PROCESSOR_NAME);
+            straggler->value = all[r].value;
+            straggler->z = z;
+            straggler->deviation = report->median != 0.0 ? diff / fabs(report->median) : INFINITY;
+        }
+    }
+    qsort(report->stragglers, report->n_stragglers, sizeof(straggler_t), compare_z_desc);
+    return 0;
+}
+
+int straggler_detect(
+    double value, bool higher_is_better, double z_threshold, MPI_Comm comm, straggler_report_t* report)
+{
+    memset(report, 0, sizeof(straggler_report_t));
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    rank_result_t local = { .value = value };
+    int hostname_len;
+    MPI_Get_processor_name(local.hostname, &hostname_len);
+    rank_result_t* all = NULL;
+    if (rank == 0) {
+        all = calloc((size_t)size, sizeof(rank_result_t));
+        if (all == NULL) {
+            perror("Failed to allocate results");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+    }
+    MPI_Gather(&local, (int)sizeof(rank_result_t), MPI_BYTE, all, (int)sizeof(rank_result_t), MPI_BYTE, 0, comm);
+    int status = 0;
+    if (rank == 0) {
+        status = find_stragglers(all, size, higher_is_better, z_threshold, report);
+        if (status != 0) {
+            perror("Failed to allocate stragglers");
+        }
+        free(all);
+    }
+    MPI_Bcast(&status, 1, MPI_INT, 0, comm);
+    if (status != 0) {
+        straggler_report_free(report);
+        return -1;
+    }
+    // The summary and the stragglers themselves are needed everywhere, e.g. to exclude them.
+    double summary[2] = { report->median, report->mad };
+    unsigned long long n_stragglers = report->n_stragglers;
+    MPI_Bcast(summary, 2, MPI_DOUBLE, 0, comm);
+    MPI_Bcast(&n_stragglers, 1, MPI_UNSIGNED_LONG_LONG, 0, comm);
+    report->median = summary[0];
+    report->mad = summary[1];
+    report->n_stragglers = (size_t)n_stragglers;
+    if (report->n_stragglers == 0) {
+        return 0;
+    }
+    if (rank != 0) {
+        report->stragglers = calloc(report->n_stragglers, sizeof(straggler_t));
+        if (report->stragglers == NULL) {
+            perror("Failed to allocate stragglers");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+    }
+    MPI_Bcast(report->stragglers, (int)(report->n_stragglers * sizeof(straggler_t)), MPI_BYTE, 0, comm);
+    return 0;
+}
+
+void straggler_report_free(straggler_report_t* report)
+{
+    free(report->stragglers);
+    memset(report, 0, sizeof(straggler_report_t));
+}
+
+void straggler_report_print(const straggler_report_t* report, const char* metric, FILE* out)
+{
+    for (size_t i = 0; i < report->n_stragglers; i++) {
+        const straggler_t* straggler = &report->stragglers[i];
+        fprintf(out, "Straggler %s: rank %d on %s: %g (median %g, %.1f%% worse, z = %.1f)\n", metric,
+            straggler->rank, straggler->hostname, straggler->value, report->median, straggler->deviation * 100.0,
+            straggler->z);
+    }
+}
+
+void straggler_exclude(const straggler_report_t* report, MPI_Comm comm, MPI_Comm* healthy)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    bool is_straggler = false;
+    for (size_t i = 0; i < report->n_stragglers; i++) {
+        is_straggler = is_straggler || report->stragglers[i].rank == rank;
+    }
+    MPI_Comm_split(comm, is_straggler ? MPI_UNDEFINED : 0, rank, healthy);
+}
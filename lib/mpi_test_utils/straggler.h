@@ -0,0 +1,79 @@
+#ifndef MPI_TEST_UTILS_STRAGGLER_H
+#define MPI_TEST_UTILS_STRAGGLER_H
+
+#include <mpi.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @file straggler.h
+ * @brief Detection of ranks whose result is an outlier among all ranks, using the modified z-score
+ * `0.6745 * (x - median) / MAD` that is not dragged along by the outliers themselves.
+ */
+
+/*!
+ * @brief Threshold on the modified z-score recommended by Iglewicz and Hoaglin.
+ */
+#define STRAGGLER_DEFAULT_Z 3.5
+
+typedef struct {
+    int rank;
+    char hostname[MPI_MAX_PROCESSOR_NAME];
+    double value;
+    /*!
+     * @brief Modified z-score, positive in the bad direction.
+     */
+    double z;
+    /*!
+     * @brief Relative deviation from the median, positive in the bad direction.
+     */
+    double deviation;
+} straggler_t;
+
+typedef struct {
+    double median;
+    double mad;
+    size_t n_stragglers;
+    /*!
+     * @brief Sorted from the worst straggler down.
+     */
+    straggler_t* stragglers;
+} straggler_report_t;
+
+/*!
+ * @brief Collective. Gather one result per rank and flag the ranks that are worse than the others.
+ *
+ * Ranks that did not take part pass NaN. Only outliers in the bad direction are flagged: low values if
+ * `higher_is_better`, high ones otherwise. Fewer than three results never yield stragglers.
+ * The report is valid on all ranks and must be released with #straggler_report_free.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int straggler_detect(
+    double value, bool higher_is_better, double z_threshold, MPI_Comm comm, straggler_report_t* report);
+
+void straggler_report_free(straggler_report_t* report);
+
+/*!
+ * @brief Print the stragglers of `metric`, if any, with their hosts.
+ */
+void straggler_report_print(const straggler_report_t* report, const char* metric, FILE* out);
+
+/*!
+ * @brief Collective. Split off the ranks that are not stragglers.
+ *
+ * Stragglers receive MPI_COMM_NULL in `healthy`.
+ */
+void straggler_exclude(const straggler_report_t* report, MPI_Comm comm, MPI_Comm* healthy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_STRAGGLER_H
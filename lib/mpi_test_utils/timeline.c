@@ -0,0 +1,238 @@
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include "mpi_test_utils/timeline.h"
+#include "mpi_test_utils/stats.h"
+
+#include <mpi.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define STALL_FRACTION 0.1
+
+static void timespec_add_ns(struct timespec* ts, uint64_t ns)
+{
+    ts->tv_sec += (time_t)(ns / 1000000000);
+    ts->tv_nsec += (long)(ns % 1000000000);
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000;
+    }
+}
+
+static void* sampler_main(void* arg)
+{
+    timeline_t* tl = arg;
+    struct timespec deadline = tl->start;
+    uint64_t last = 0;
+    pthread_mutex_lock(&tl->mutex);
+    while (tl->running) {
+        timespec_add_ns(&deadline, tl->interval_ns);
+        int rc = 0;
+        while (tl->running && rc != ETIMEDOUT) {
+            rc = pthread_cond_timedwait(&tl->cond, &tl->mutex, &deadline);
+        }
+        if (!tl->running) {
+            break;
+        }
+        if (tl->n_samples == tl->capacity) {
+            tl->overflow = true;
+            continue;
+        }
+        uint64_t now = atomic_load_explicit(&tl->completed, memory_order_relaxed);
+        tl->bytes[tl->n_samples++] = now - last;
+        last = now;
+    }
+    pthread_mutex_unlock(&tl->mutex);
+    return NULL;
+}
+
+int timeline_init(timeline_t* tl, uint64_t interval_ns, size_t capacity)
+{
+    memset(tl, 0, sizeof(timeline_t));
+    tl->interval_ns = interval_ns;
+    tl->capacity = capacity;
+    // One extra slot for the tail interval.
+    tl->bytes = calloc(capacity + 1, sizeof(uint64_t));
+    if (tl->bytes == NULL) {
+        perror("Failed to allocate timeline");
+        return -1;
+    }
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&tl->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&tl->mutex, NULL);
+    atomic_init(&tl->completed, 0);
+    return 0;
+}
+
+void timeline_free(timeline_t* tl)
+{
+    pthread_cond_destroy(&tl->cond);
+    pthread_mutex_destroy(&tl->mutex);
+    free(tl->bytes);
+    tl->bytes = NULL;
+}
+
+int timeline_start(timeline_t* tl)
+{
+    tl->n_samples = 0;
+    tl->tail_ns = 0;
+    tl->overflow = false;
+    atomic_store_explicit(&tl->completed, 0, memory_order_relaxed);
+    tl->running = true;
+    clock_gettime(CLOCK_MONOTONIC, &tl->start);
+    int rc = pthread_create(&tl->sampler, NULL, sampler_main, tl);
+    if (rc != 0) {
+        fprintf(stderr, "Failed to start timeline sampler: %s\n", strerror(rc));
+        tl->running = false;
+        return -1;
+    }
+    return 0;
+}
+
+void timeline_stop(timeline_t* tl)
+{
+    if (!tl->running) {
+        return;
+    }
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_mutex_lock(&tl->mutex);
+    tl->running = false;
+    pthread_cond_signal(&tl->cond);
+    pthread_mutex_unlock(&tl->mutex);
+    pthread_join(tl->sampler, NULL);
+
+    uint64_t recorded = 0;
+    for (size_t i = 0; i < tl->n_samples; i++) {
+        recorded += tl->bytes[i];
+    }
+    uint64_t elapsed_ns = (uint64_t)((end.tv_sec - tl->start.tv_sec) * 1000000000 + (end.tv_nsec - tl->start.tv_nsec));
+    uint64_t covered_ns = tl->n_samples * tl->interval_ns;
+    uint64_t remaining = atomic_load_explicit(&tl->completed, memory_order_relaxed) - recorded;
+    if (remaining > 0 || elapsed_ns > covered_ns) {
+        tl->tail_ns = elapsed_ns > covered_ns ? elapsed_ns - covered_ns : 1;
+        tl->bytes[tl->n_samples++] = remaining;
+    }
+}
+
+size_t timeline_reduce(const timeline_t* tl, MPI_Comm comm, int root, uint64_t** merged, bool* overflow)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    uint64_t local_n = tl->tail_ns > 0 ? tl->n_samples - 1 : tl->n_samples;
+    uint64_t max_n = 0;
+    MPI_Allreduce(&local_n, &max_n, 1, MPI_UINT64_T, MPI_MAX, comm);
+    int local_overflow = tl->overflow;
+    int any_overflow = 0;
+    MPI_Reduce(&local_overflow, &any_overflow, 1, MPI_INT, MPI_LOR, root, comm);
+    if (rank == root) {
+        *overflow = any_overflow;
+    }
+    if (max_n == 0) {
+        return 0;
+    }
+    // Pad ranks that finished earlier with zeros.
+    uint64_t* padded = calloc(max_n, sizeof(uint64_t));
+    uint64_t* sum = rank == root ? calloc(max_n, sizeof(uint64_t)) : NULL;
+    int failed = padded == NULL || (rank == root && sum == NULL);
+    int any_failed = 0;
+    MPI_Allreduce(&failed, &any_failed, 1, MPI_INT, MPI_LOR, comm);
+    if (any_failed) {
+        perror("Failed to allocate timeline");
+        free(padded);
+        free(sum);
+        return 0;
+    }
+    memcpy(padded, tl->bytes, local_n * sizeof(uint64_t));
+    MPI_Reduce(padded, sum, (int)max_n, MPI_UINT64_T, MPI_SUM, root, comm);
+    free(padded);
+    if (rank == root) {
+        *merged = sum;
+    }
+    return max_n;
+}
+
+static double interval_bandwidth(uint64_t interval_ns, const uint64_t* bytes, size_t n_samples, uint64_t tail_ns,
+    size_t idx)
+{
+    uint64_t duration_ns = (idx == n_samples - 1 && tail_ns > 0) ? tail_ns : interval_ns;
+    return (double)bytes[idx] / (double)duration_ns * 1e3; // bytes per ns convert to MB/s
+}
+
+int timeline_write_csv(
+    const char* path, uint64_t interval_ns, const uint64_t* bytes, size_t n_samples, uint64_t tail_ns)
+{
+    FILE* file = fopen(path, "we");
+    if (file == NULL) {
+        perror("Failed to open timeline file for writing");
+        return -1;
+    }
+    fprintf(file, "time_s,bytes,bandwidth_mbps\n");
+    for (size_t i = 0; i < n_samples; i++) {
+        fprintf(file, "%.3f,%" PRIu64 ",%.3f\n", (double)(i * interval_ns) / 1e9, bytes[i],
+            interval_bandwidth(interval_ns, bytes, n_samples, tail_ns, i));
+    }
+    fclose(file);
+    return 0;
+}
+
+void timeline_summarize(
+    uint64_t interval_ns, const uint64_t* bytes, size_t n_samples, uint64_t tail_ns, FILE* out)
+{
+    if (n_samples == 0) {
+        fprintf(out, "  timeline: no samples\n");
+        return;
+    }
+    double* bandwidth = calloc(n_samples, sizeof(double));
+    if (bandwidth == NULL) {
+        return;
+    }
+    double peak = 0.0;
+    uint64_t total_bytes = 0;
+    uint64_t total_ns = 0;
+    for (size_t i = 0; i < n_samples; i++) {
+        bandwidth[i] = interval_bandwidth(interval_ns, bytes, n_samples, tail_ns, i);
+        if (bandwidth[i] > peak) {
+            peak = bandwidth[i];
+        }
+        total_bytes += bytes[i];
+        total_ns += (i == n_samples - 1 && tail_ns > 0) ? tail_ns : interval_ns;
+    }
+    // The tail interval is usually partial and noisy, so it is excluded from the steady state when possible.
+    size_t n_steady = tail_ns > 0 && n_samples > 1 ? n_samples - 1 : n_samples;
+    double steady = stats_median(bandwidth, n_steady);
+    size_t n_stall = 0;
+    size_t longest_stall = 0;
+    size_t current_stall = 0;
+    for (size_t i = 0; i < n_steady; i++) {
+        if (bandwidth[i] < steady * STALL_FRACTION) {
+            n_stall++;
+            current_stall++;
+            if (current_stall > longest_stall) {
+                longest_stall = current_stall;
+            }
+        } else {
+            current_stall = 0;
+        }
+    }
+    fprintf(out, "  timeline: peak %.3f MB/s, steady %.3f MB/s, mean %.3f MB/s, %zu stalled of %zu intervals",
+        peak, steady, (double)total_bytes / (double)total_ns * 1e3, n_stall, n_samples);
+    if (longest_stall > 0) {
+        fprintf(out, " (longest %.3f s)", (double)(longest_stall * interval_ns) / 1e9);
+    }
+    fprintf(out, "\n");
+    free(bandwidth);
+}
@@ -0,0 +1,103 @@
+#ifndef MPI_TEST_UTILS_TIMELINE_H
+#define MPI_TEST_UTILS_TIMELINE_H
+
+// Enable POSIX extensions
+#define _POSIX_C_SOURCE 200809L // NOLINT
+
+#include <mpi.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @brief Bandwidth-over-time recorder.
+ *
+ * I/O engines only add completed bytes to an atomic counter with #timeline_add.
+ * A sampler thread wakes up every `interval_ns` and stores the bytes completed since its previous wake-up
+ * into a preallocated buffer, so the clock is never read on the I/O path.
+ */
+typedef struct timeline {
+    uint64_t interval_ns;
+    size_t capacity;
+    size_t n_samples;
+    uint64_t* bytes;
+    /*!
+     * @brief Duration of the last, possibly partial, interval.
+     */
+    uint64_t tail_ns;
+    /*!
+     * @brief More than `capacity` intervals elapsed; the rest of the run was folded into the tail.
+     */
+    bool overflow;
+    atomic_uint_fast64_t completed;
+    bool running;
+    pthread_t sampler;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    struct timespec start;
+} timeline_t;
+
+/*!
+ * @brief Allocate a timeline holding at most `capacity` intervals of `interval_ns` each.
+ * @return 0 on success, -1 on failure.
+ */
+int timeline_init(timeline_t* tl, uint64_t interval_ns, size_t capacity);
+void timeline_free(timeline_t* tl);
+
+/*!
+ * @brief Clear previous samples and start the sampler thread.
+ * @return 0 on success, -1 on failure.
+ */
+int timeline_start(timeline_t* tl);
+
+/*!
+ * @brief Stop the sampler thread and record the last partial interval.
+ */
+void timeline_stop(timeline_t* tl);
+
+static inline void timeline_add(timeline_t* tl, uint64_t bytes)
+{
+    if (tl != NULL) {
+        atomic_fetch_add_explicit(&tl->completed, bytes, memory_order_relaxed);
+    }
+}
+
+/*!
+ * @brief Sum per-interval bytes of all ranks of `comm` on `root`.
+ *
+ * Intervals are aligned by index, so ranks should start their timelines right after a barrier.
+ * Only full intervals are merged: the partial tail of each rank covers a different duration and is dropped.
+ * On `root`, `*merged` is allocated and must be freed by the caller, and `*overflow` tells whether any rank
+ * ran out of capacity, in which case the merged intervals end before the run did.
+ *
+ * @return Number of merged intervals, or 0 on failure.
+ */
+size_t timeline_reduce(const timeline_t* tl, MPI_Comm comm, int root, uint64_t** merged, bool* overflow);
+
+/*!
+ * @brief Write intervals as CSV with columns time (s), bytes and bandwidth (MB/s).
+ */
+int timeline_write_csv(
+    const char* path, uint64_t interval_ns, const uint64_t* bytes, size_t n_samples, uint64_t tail_ns);
+
+/*!
+ * @brief Print peak, steady-state (median) and mean bandwidth, and stall periods
+ * (intervals below 10 % of the steady-state bandwidth).
+ */
+void timeline_summarize(
+    uint64_t interval_ns, const uint64_t* bytes, size_t n_samples, uint64_t tail_ns, FILE* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_TIMELINE_H
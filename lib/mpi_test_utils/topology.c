@@ -0,0 +1,128 @@
+// sched_setaffinity and syscall() are Linux-specific
+#define _GNU_SOURCE // NOLINT
+
+#include "mpi_test_utils/topology.h"
+
+#include <linux/mempolicy.h>
+
+#include <sched.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Parse a sysfs list such as "0-3,8-11,16".
+static int parse_list(FILE* file, int* values, int max_values)
+{
+    int n = 0;
+    int first, last;
+    char sep;
+    while (fscanf(file, "%d", &first) == 1) {
+        last = first;
+        sep = (char)fgetc(file);
+        if (sep == '-') {
+            if (fscanf(file, "%d", &last) != 1) {
+                break;
+            }
+            sep = (char)fgetc(file);
+        }
+        for (int value = first; value <= last && n < max_values; value++) {
+            values[n++] = value;
+        }
+        if (sep != ',') {
+            break;
+        }
+    }
+    return n;
+}
+
+int topology_online_nodes(int* nodes, int max_nodes)
+{
+    if (max_nodes <= 0) {
+        return 0;
+    }
+    FILE* file = fopen("/sys/devices/system/node/online", "re");
+    int n = 0;
+    if (file != NULL) {
+        n = parse_list(file, nodes, max_nodes);
+        fclose(file);
+    }
+    if (n == 0) {
+        nodes[0] = 0;
+        n = 1;
+    }
+    return n;
+}
+
+int topology_numa_nodes(int* nodes, int max_nodes)
+{
+    int online[TOPOLOGY_MAX_NODES];
+    int n_online = topology_online_nodes(online, TOPOLOGY_MAX_NODES);
+    int cpus[CPU_SETSIZE];
+    int n = 0;
+    for (int i = 0; i < n_online && n < max_nodes; i++) {
+        if (topology_node_cpus(online[i], cpus, CPU_SETSIZE) > 0) {
+            nodes[n++] = online[i];
+        }
+    }
+    return n;
+}
+
+int topology_node_cpus(int node, int* cpus, int max_cpus)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE* file = fopen(path, "re");
+    if (file == NULL) {
+        if (node != 0) {
+            return -1;
+        }
+        // No NUMA information: node 0 owns every online CPU.
+        long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        int n = 0;
+        for (long cpu = 0; cpu < n_cpus && n < max_cpus; cpu++) {
+            cpus[n++] = (int)cpu;
+        }
+        return n;
+    }
+    int n = parse_list(file, cpus, max_cpus);
+    fclose(file);
+    return n;
+}
+
+int topology_bind_thread(int node)
+{
+    int cpus[CPU_SETSIZE];
+    int n_cpus = topology_node_cpus(node, cpus, CPU_SETSIZE);
+    if (n_cpus <= 0) {
+        fprintf(stderr, "NUMA node %d has no CPUs\n", node);
+        return -1;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int i = 0; i < n_cpus; i++) {
+        CPU_SET(cpus[i], &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        perror("Failed to set CPU affinity");
+        return -1;
+    }
+    return 0;
+}
+
+int topology_bind_memory(void* addr, size_t len, int node)
+{
+    if (node < 0 || node >= TOPOLOGY_MAX_NODES) {
+        return -1;
+    }
+    unsigned long nodemask[TOPOLOGY_MAX_NODES / (8 * sizeof(unsigned long))];
+    memset(nodemask, 0, sizeof(nodemask));
+    nodemask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_mbind, addr, len, MPOL_BIND, nodemask, (unsigned long)TOPOLOGY_MAX_NODES, 0) != 0) {
+        perror("Failed to bind memory to NUMA node");
+        return -1;
+    }
+    return 0;
+}
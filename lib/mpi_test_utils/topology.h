@@ -0,0 +1,57 @@
+#ifndef MPI_TEST_UTILS_TOPOLOGY_H
+#define MPI_TEST_UTILS_TOPOLOGY_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @file topology.h
+ * @brief NUMA topology from sysfs and binding through raw system calls, so that libnuma is not required.
+ */
+
+/*!
+ * @brief Upper bound of NUMA node IDs.
+ */
+#define TOPOLOGY_MAX_NODES 1024
+
+/*!
+ * @brief IDs of the online NUMA nodes in ascending order, parsed from `/sys/devices/system/node/online`.
+ *
+ * IDs may be sparse, e.g. with offline nodes. If the system exposes no NUMA information, node 0 is reported.
+ * @return Number of IDs stored into `nodes` (at most `max_nodes`).
+ */
+int topology_online_nodes(int* nodes, int max_nodes);
+
+/*!
+ * @brief Like #topology_online_nodes, but only nodes with CPUs, i.e. those #topology_bind_thread accepts.
+ * Memory-only nodes such as CXL expanders are skipped.
+ */
+int topology_numa_nodes(int* nodes, int max_nodes);
+
+/*!
+ * @brief CPUs of a NUMA node, parsed from `/sys/devices/system/node/node<N>/cpulist`.
+ * @return Number of CPUs stored into `cpus` (at most `max_cpus`), or -1 on failure.
+ */
+int topology_node_cpus(int node, int* cpus, int max_cpus);
+
+/*!
+ * @brief Restrict the calling thread to the CPUs of `node`.
+ * @return 0 on success, -1 on failure.
+ */
+int topology_bind_thread(int node);
+
+/*!
+ * @brief Bind the pages of `[addr, addr + len)` to `node`. Must be called before the pages are first touched.
+ * `addr` must be page-aligned.
+ * @return 0 on success, -1 on failure.
+ */
+int topology_bind_memory(void* addr, size_t len, int node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_TOPOLOGY_H
@@ -0,0 +1,157 @@
+// syscall() and MAP_POPULATE are Linux-specific
+#define _GNU_SOURCE // NOLINT
+
+#include "mpi_test_utils/uring.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef MPI_TEST_UTILS_HAVE_IO_URING
+
+#include <linux/io_uring.h>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int uring_init(uring_t* ring, unsigned entries)
+{
+    memset(ring, 0, sizeof(uring_t));
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+        return -1;
+    }
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+        IORING_OFF_SQ_RING);
+    ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+        IORING_OFF_CQ_RING);
+    void* sqes = mmap(
+        NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || sqes == MAP_FAILED) {
+        int saved_errno = errno;
+        ring->sq_ring = ring->sq_ring == MAP_FAILED ? NULL : ring->sq_ring;
+        ring->cq_ring = ring->cq_ring == MAP_FAILED ? NULL : ring->cq_ring;
+        ring->sqes = sqes == MAP_FAILED ? NULL : sqes;
+        uring_exit(ring);
+        errno = saved_errno;
+        return -1;
+    }
+    char* sq = ring->sq_ring;
+    char* cq = ring->cq_ring;
+    ring->sqes = sqes;
+    ring->sq_entries = params.sq_entries;
+    ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = cq + params.cq_off.cqes;
+    ring->sqe_tail = *ring->sq_tail;
+    return 0;
+}
+
+void uring_exit(uring_t* ring)
+{
+    if (ring->sqes != NULL) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring != NULL) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring != NULL) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->fd >= 0) {
+        close(ring->fd);
+    }
+    memset(ring, 0, sizeof(uring_t));
+    ring->fd = -1;
+}
+
+struct io_uring_sqe* uring_get_sqe(uring_t* ring)
+{
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sqe_tail - head >= ring->sq_entries) {
+        return NULL;
+    }
+    unsigned idx = ring->sqe_tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[idx];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    ring->sq_array[idx] = idx;
+    ring->sqe_tail++;
+    ring->to_submit++;
+    return sqe;
+}
+
+int uring_submit_and_wait(uring_t* ring, unsigned wait_nr)
+{
+    // Publish queued entries to the kernel.
+    __atomic_store_n(ring->sq_tail, ring->sqe_tail, __ATOMIC_RELEASE);
+    unsigned to_submit = ring->to_submit;
+    ring->to_submit = 0;
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int submitted = 0;
+    do {
+        submitted = (int)syscall(__NR_io_uring_enter, ring->fd, to_submit, wait_nr, flags, NULL, 0);
+    } while (submitted < 0 && errno == EINTR);
+    return submitted;
+}
+
+int uring_pop_cqe(uring_t* ring, uint64_t* user_data, int32_t* res)
+{
+    unsigned head = *ring->cq_head;
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    const struct io_uring_cqe* cqe = &((const struct io_uring_cqe*)ring->cqes)[head & *ring->cq_mask];
+    *user_data = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+#else
+
+int uring_init(uring_t* ring, unsigned entries)
+{
+    (void)entries;
+    memset(ring, 0, sizeof(uring_t));
+    ring->fd = -1;
+    errno = ENOSYS;
+    return -1;
+}
+
+void uring_exit(uring_t* ring) { (void)ring; }
+
+struct io_uring_sqe* uring_get_sqe(uring_t* ring)
+{
+    (void)ring;
+    return NULL;
+}
+
+int uring_submit_and_wait(uring_t* ring, unsigned wait_nr)
+{
+    (void)ring;
+    (void)wait_nr;
+    errno = ENOSYS;
+    return -1;
+}
+
+int uring_pop_cqe(uring_t* ring, uint64_t* user_data, int32_t* res)
+{
+    (void)ring;
+    (void)user_data;
+    (void)res;
+    return 0;
+}
+
+#endif
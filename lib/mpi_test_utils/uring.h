@@ -0,0 +1,69 @@
+#ifndef MPI_TEST_UTILS_URING_H
+#define MPI_TEST_UTILS_URING_H
+
+/*!
+ * @file uring.h
+ * @brief Minimal io_uring ring on top of the raw system calls, so no liburing is required.
+ *
+ * Only available if the build system defined `MPI_TEST_UTILS_HAVE_IO_URING`.
+ * Otherwise #uring_init always fails with `ENOSYS`.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct io_uring_sqe;
+
+typedef struct {
+    int fd;
+    unsigned sq_entries;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    void* cqes;
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    unsigned sqe_tail;
+    unsigned to_submit;
+} uring_t;
+
+/*!
+ * @return 0 on success, -1 with `errno` set on failure.
+ */
+int uring_init(uring_t* ring, unsigned entries);
+void uring_exit(uring_t* ring);
+
+/*!
+ * @brief Get a zeroed submission queue entry, or NULL if the queue is full.
+ */
+struct io_uring_sqe* uring_get_sqe(uring_t* ring);
+
+/*!
+ * @brief Submit all queued entries and wait for at least `wait_nr` completions.
+ * @return Number of submitted entries, or -1 with `errno` set on failure.
+ */
+int uring_submit_and_wait(uring_t* ring, unsigned wait_nr);
+
+/*!
+ * @brief Pop one completion if available.
+ * @return 1 if a completion was stored into `user_data` and `res`, 0 if the completion queue is empty.
+ */
+int uring_pop_cqe(uring_t* ring, uint64_t* user_data, int32_t* res);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MPI_TEST_UTILS_URING_H